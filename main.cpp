@@ -5,12 +5,13 @@
 #include <date.h>
 #include <vulkanapp.cpp>
 
-int main()
+int main(int argc, char **argv)
 {
     VulkanApp app;
 
     try
     {
+        app.configure(argc, argv);
         app.run();
     }
     catch(const std::exception& e)
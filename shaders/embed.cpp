@@ -0,0 +1,122 @@
+//Packs compiled SPIR-V into a header as uint32_t arrays with an index by file
+//name, so the executable carries its shaders and loads them without file I/O, and
+//a hash of the SPIR-V to check it against shaderlayout.h.
+//usage: embed <output.h> <shader.spv>...
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <ctype.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+static const uint32_t SPIRV_MAGIC = 0x07230203;
+static const size_t WORDS_PER_LINE = 8;
+
+static void fail(const std::string &message)
+{
+    std::cerr << "embed: " << message << std::endl;
+    exit(1);
+}
+
+//vert.spv becomes SHADER_VERT_SPV
+static std::string getArrayName(const std::string &path)
+{
+    std::string fileName = path.substr(path.find_last_of("/\\") + 1);
+
+    std::string name = "SHADER_";
+    for(char c : fileName)
+    { name += isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(toupper(c)) : '_'; }
+
+    return name;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 3)
+    {
+        std::cerr << "usage: embed <output.h> <shader.spv>..." << std::endl;
+        return 1;
+    }
+
+    std::ostringstream out;
+    out << "//generated by shaders/embed.cpp from";
+    for(int i = 2; i < argc; i++)
+    { out << " " << argv[i]; }
+    out << ", do not edit\n";
+    out << "#ifndef SHADER_BINARIES_H\n#define SHADER_BINARIES_H\n";
+    out << "#include <stdint.h>\n#include <stddef.h>\n#include <string.h>\n\n";
+
+    std::ostringstream index;
+    //fnv-1a over the bytes of every file in order, the same as reflect.cpp
+    uint64_t hash = 14695981039346656037ull;
+
+    for(int i = 2; i < argc; i++)
+    {
+        std::string path = argv[i];
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file.is_open()) fail("failed to open " + path);
+
+        size_t size = static_cast<size_t>(file.tellg());
+        if(size % 4 != 0 || size == 0) fail(path + " is not SPIR-V");
+
+        std::vector<uint32_t> words(size / 4);
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(words.data()), size);
+
+        if(words[0] != SPIRV_MAGIC) fail(path + " is not SPIR-V");
+
+        for(uint32_t word : words)
+        {
+            for(int byte = 0; byte < 4; byte++)
+            {
+                hash ^= (word >> (byte * 8)) & 0xff;
+                hash *= 1099511628211ull;
+            }
+        }
+
+        std::string arrayName = getArrayName(path);
+        out << "static const uint32_t " << arrayName << "[] =\n{";
+
+        for(size_t w = 0; w < words.size(); w++)
+        {
+            if(w % WORDS_PER_LINE == 0) out << "\n    ";
+            out << "0x" << std::hex << std::setw(8) << std::setfill('0') << words[w] << std::dec
+                << (w + 1 < words.size() ? ", " : "");
+        }
+
+        out << "\n};\n\n";
+
+        std::string name = path.substr(path.find_last_of("/\\") + 1);
+        index << "    {\"" << name << "\", " << arrayName << ", sizeof(" << arrayName << ")}"
+            << (i + 1 < argc ? "," : "") << "\n";
+    }
+
+    //shaderlayout.h carries the same value when both were made from the same SPIR-V
+    out << "constexpr uint64_t SHADER_BINARIES_SPIRV_HASH = 0x" << std::hex << std::setw(16) << std::setfill('0')
+        << hash << std::dec << "ull;\n\n";
+
+    out << "struct EmbeddedShader\n{\n    const char *name;\n    const uint32_t *code;\n    size_t size;\n};\n\n";
+    out << "static const EmbeddedShader EMBEDDED_SHADERS[] =\n{\n" << index.str() << "};\n\n";
+
+    out << "//nullptr when nothing of that name was embedded\n";
+    out << "inline const EmbeddedShader *findEmbeddedShader(const char *name)\n{\n";
+    out << "    for(const EmbeddedShader &shader : EMBEDDED_SHADERS)\n    {\n";
+    out << "        if(strcmp(shader.name, name) == 0) return &shader;\n    }\n\n";
+    out << "    return nullptr;\n}\n\n";
+    out << "#endif\n";
+
+    //left alone when nothing changed so everything including it is not rebuilt
+    std::ifstream previous(argv[1], std::ios::binary);
+    std::stringstream previousContents;
+    previousContents << previous.rdbuf();
+    if(previous.is_open() && previousContents.str() == out.str()) return 0;
+
+    std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+    file << out.str();
+    if(!file) fail("failed to write " + std::string(argv[1]));
+
+    return 0;
+}
@@ -0,0 +1,777 @@
+//Reads compiled SPIR-V and writes a C++ header with what the renderer would otherwise
+//copy out of the shaders by hand: descriptor bindings, pool sizes, uniform and push
+//constant structs with their offsets checked, the vertex input attributes, the
+//ids of the specialization constants and a hash of the SPIR-V it was made from.
+//usage: reflect <output.h> <shader.spv>...
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <iomanip>
+#include <stdlib.h>
+#include <stdint.h>
+
+static const uint32_t SPIRV_MAGIC = 0x07230203;
+
+enum Op
+{
+    OP_NAME = 5,
+    OP_MEMBER_NAME = 6,
+    OP_ENTRY_POINT = 15,
+    OP_TYPE_BOOL = 20,
+    OP_TYPE_INT = 21,
+    OP_TYPE_FLOAT = 22,
+    OP_TYPE_VECTOR = 23,
+    OP_TYPE_MATRIX = 24,
+    OP_TYPE_IMAGE = 25,
+    OP_TYPE_SAMPLER = 26,
+    OP_TYPE_SAMPLED_IMAGE = 27,
+    OP_TYPE_ARRAY = 28,
+    OP_TYPE_RUNTIME_ARRAY = 29,
+    OP_TYPE_STRUCT = 30,
+    OP_TYPE_POINTER = 32,
+    OP_CONSTANT = 43,
+    OP_SPEC_CONSTANT_TRUE = 48,
+    OP_SPEC_CONSTANT_FALSE = 49,
+    OP_SPEC_CONSTANT = 50,
+    OP_VARIABLE = 59,
+    OP_DECORATE = 71,
+    OP_MEMBER_DECORATE = 72
+};
+
+enum Decoration
+{
+    DECORATION_SPEC_ID = 1,
+    DECORATION_BLOCK = 2,
+    DECORATION_BUFFER_BLOCK = 3,
+    DECORATION_ROW_MAJOR = 4,
+    DECORATION_ARRAY_STRIDE = 6,
+    DECORATION_MATRIX_STRIDE = 7,
+    DECORATION_BUILT_IN = 11,
+    DECORATION_LOCATION = 30,
+    DECORATION_BINDING = 33,
+    DECORATION_DESCRIPTOR_SET = 34,
+    DECORATION_OFFSET = 35
+};
+
+enum StorageClass
+{
+    STORAGE_UNIFORM_CONSTANT = 0,
+    STORAGE_INPUT = 1,
+    STORAGE_UNIFORM = 2,
+    STORAGE_PUSH_CONSTANT = 9,
+    STORAGE_STORAGE_BUFFER = 12
+};
+
+enum ExecutionModel
+{
+    EXECUTION_VERTEX = 0,
+    EXECUTION_FRAGMENT = 4,
+    EXECUTION_COMPUTE = 5
+};
+
+static const uint32_t IMAGE_DIM_BUFFER = 5;
+
+struct Member
+{
+    std::string name;
+    uint32_t type;
+    uint32_t offset;
+    uint32_t matrixStride;
+    bool rowMajor;
+};
+
+struct Type
+{
+    uint32_t op;
+    //component width, vector size, column count or array length
+    uint32_t width;
+    uint32_t count;
+    bool isSigned;
+    //component, column, element or pointee type
+    uint32_t element;
+    uint32_t storageClass;
+    uint32_t arrayStride;
+    uint32_t imageDim;
+    uint32_t imageSampled;
+    bool block;
+    bool bufferBlock;
+    std::vector<Member> members;
+};
+
+struct Variable
+{
+    uint32_t id;
+    uint32_t pointerType;
+    uint32_t storageClass;
+};
+
+struct Decorations
+{
+    bool hasLocation = false;
+    bool hasBinding = false;
+    bool builtIn = false;
+    bool hasSpecId = false;
+    uint32_t specId = 0;
+    uint32_t location = 0;
+    uint32_t binding = 0;
+    uint32_t set = 0;
+};
+
+struct Module
+{
+    std::string path;
+    uint32_t executionModel = UINT32_MAX;
+    std::map<uint32_t, std::string> names;
+    std::map<uint32_t, Type> types;
+    std::map<uint32_t, uint32_t> constants;
+    std::map<uint32_t, Decorations> decorations;
+    std::vector<Variable> variables;
+    std::vector<uint32_t> specConstants;
+    std::vector<uint32_t> words;
+};
+
+struct Binding
+{
+    uint32_t binding;
+    std::string type;
+    uint32_t count;
+    uint32_t stages;
+    std::string name;
+};
+
+struct Attribute
+{
+    uint32_t location;
+    std::string format;
+    uint32_t size;
+    std::string name;
+};
+
+//a uniform or push constant block written out as a struct
+struct Block
+{
+    std::string name;
+    const Module *module;
+    uint32_t type;
+    bool uniform;
+};
+
+static void fail(const std::string &message)
+{
+    std::cerr << "reflect: " << message << std::endl;
+    exit(1);
+}
+
+//fnv-1a over the bytes of every module in order
+static uint64_t hashModules(const std::vector<Module> &modules)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for(const Module &module : modules)
+    {
+        for(uint32_t word : module.words)
+        {
+            for(int byte = 0; byte < 4; byte++)
+            {
+                hash ^= (word >> (byte * 8)) & 0xff;
+                hash *= 1099511628211ull;
+            }
+        }
+    }
+
+    return hash;
+}
+
+static std::string readString(const std::vector<uint32_t> &words, size_t first, size_t end)
+{
+    std::string result;
+    for(size_t i = first; i < end; i++)
+    {
+        for(int byte = 0; byte < 4; byte++)
+        {
+            char c = static_cast<char>((words[i] >> (byte * 8)) & 0xff);
+            if(c == '\0') return result;
+            result += c;
+        }
+    }
+
+    return result;
+}
+
+static Module parse(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file.is_open()) fail("failed to open " + path);
+
+    size_t size = static_cast<size_t>(file.tellg());
+    if(size % 4 != 0 || size < 20) fail(path + " is not SPIR-V");
+
+    std::vector<uint32_t> words(size / 4);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(words.data()), size);
+
+    if(words[0] != SPIRV_MAGIC) fail(path + " is not SPIR-V");
+
+    Module module;
+    module.path = path;
+    module.words = words;
+
+    size_t i = 5;
+    while(i < words.size())
+    {
+        uint32_t op = words[i] & 0xffff;
+        uint32_t count = words[i] >> 16;
+        if(count == 0 || i + count > words.size()) fail(path + " is damaged");
+
+        const uint32_t *operands = &words[i + 1];
+
+        switch(op)
+        {
+            case OP_NAME:
+                module.names[operands[0]] = readString(words, i + 2, i + count);
+                break;
+            case OP_MEMBER_NAME:
+            {
+                Type &type = module.types[operands[0]];
+                if(type.members.size() <= operands[1]) type.members.resize(operands[1] + 1);
+                type.members[operands[1]].name = readString(words, i + 3, i + count);
+                break;
+            }
+            case OP_ENTRY_POINT:
+                if(module.executionModel != UINT32_MAX) fail(path + " has more than one entry point");
+                module.executionModel = operands[0];
+                break;
+            case OP_TYPE_BOOL:
+            case OP_TYPE_SAMPLER:
+                module.types[operands[0]].op = op;
+                break;
+            case OP_TYPE_INT:
+            case OP_TYPE_FLOAT:
+            {
+                Type &type = module.types[operands[0]];
+                type.op = op;
+                type.width = operands[1];
+                type.isSigned = op == OP_TYPE_FLOAT || operands[2] != 0;
+                break;
+            }
+            case OP_TYPE_VECTOR:
+            case OP_TYPE_MATRIX:
+            case OP_TYPE_SAMPLED_IMAGE:
+            case OP_TYPE_RUNTIME_ARRAY:
+            {
+                Type &type = module.types[operands[0]];
+                type.op = op;
+                type.element = operands[1];
+                type.count = op == OP_TYPE_VECTOR || op == OP_TYPE_MATRIX ? operands[2] : 0;
+                break;
+            }
+            case OP_TYPE_IMAGE:
+            {
+                Type &type = module.types[operands[0]];
+                type.op = op;
+                type.imageDim = operands[2];
+                type.imageSampled = operands[6];
+                break;
+            }
+            case OP_TYPE_ARRAY:
+            {
+                Type &type = module.types[operands[0]];
+                type.op = op;
+                type.element = operands[1];
+                //only literal lengths, specialization constants are not known here
+                auto length = module.constants.find(operands[2]);
+                if(length == module.constants.end()) fail(path + " has an array of unknown length");
+                type.count = length->second;
+                break;
+            }
+            case OP_TYPE_STRUCT:
+            {
+                Type &type = module.types[operands[0]];
+                type.op = op;
+                if(type.members.size() < count - 2) type.members.resize(count - 2);
+                for(uint32_t m = 0; m < count - 2; m++)
+                { type.members[m].type = operands[1 + m]; }
+                break;
+            }
+            case OP_TYPE_POINTER:
+            {
+                Type &type = module.types[operands[0]];
+                type.op = op;
+                type.storageClass = operands[1];
+                type.element = operands[2];
+                break;
+            }
+            case OP_CONSTANT:
+                module.constants[operands[1]] = operands[2];
+                break;
+            case OP_SPEC_CONSTANT_TRUE:
+            case OP_SPEC_CONSTANT_FALSE:
+            case OP_SPEC_CONSTANT:
+                module.specConstants.push_back(operands[1]);
+                break;
+            case OP_VARIABLE:
+                module.variables.push_back({operands[1], operands[0], operands[2]});
+                break;
+            case OP_DECORATE:
+            {
+                Decorations &decorations = module.decorations[operands[0]];
+                Type &type = module.types[operands[0]];
+                if(operands[1] == DECORATION_BLOCK) type.block = true;
+                else if(operands[1] == DECORATION_BUFFER_BLOCK) type.bufferBlock = true;
+                else if(operands[1] == DECORATION_ARRAY_STRIDE) type.arrayStride = operands[2];
+                else if(operands[1] == DECORATION_BUILT_IN) decorations.builtIn = true;
+                else if(operands[1] == DECORATION_SPEC_ID)
+                {
+                    decorations.hasSpecId = true;
+                    decorations.specId = operands[2];
+                }
+                else if(operands[1] == DECORATION_LOCATION)
+                {
+                    decorations.hasLocation = true;
+                    decorations.location = operands[2];
+                }
+                else if(operands[1] == DECORATION_BINDING)
+                {
+                    decorations.hasBinding = true;
+                    decorations.binding = operands[2];
+                }
+                else if(operands[1] == DECORATION_DESCRIPTOR_SET) decorations.set = operands[2];
+                break;
+            }
+            case OP_MEMBER_DECORATE:
+            {
+                Type &type = module.types[operands[0]];
+                if(type.members.size() <= operands[1]) type.members.resize(operands[1] + 1);
+                Member &member = type.members[operands[1]];
+                if(operands[2] == DECORATION_OFFSET) member.offset = operands[3];
+                else if(operands[2] == DECORATION_MATRIX_STRIDE) member.matrixStride = operands[3];
+                else if(operands[2] == DECORATION_ROW_MAJOR) member.rowMajor = true;
+                break;
+            }
+        }
+
+        i += count;
+    }
+
+    if(module.executionModel == UINT32_MAX) fail(path + " has no entry point");
+
+    //decorations made placeholder entries for ids that are not types
+    for(auto it = module.types.begin(); it != module.types.end();)
+    {
+        if(it->second.op == 0) it = module.types.erase(it);
+        else ++it;
+    }
+
+    return module;
+}
+
+static const Type &getType(const Module &module, uint32_t id)
+{
+    auto type = module.types.find(id);
+    if(type == module.types.end()) fail(module.path + " uses an unknown type");
+
+    return type->second;
+}
+
+static std::string getName(const Module &module, uint32_t id, const std::string &fallback)
+{
+    auto name = module.names.find(id);
+    if(name == module.names.end() || name->second.empty()) return fallback;
+
+    return name->second;
+}
+
+static std::string getStageFlags(uint32_t stages)
+{
+    std::string result;
+    const char *names[] = {"VK_SHADER_STAGE_VERTEX_BIT", "VK_SHADER_STAGE_FRAGMENT_BIT", "VK_SHADER_STAGE_COMPUTE_BIT"};
+    for(int i = 0; i < 3; i++)
+    {
+        if((stages & (1u << i)) == 0) continue;
+        if(!result.empty()) result += " | ";
+        result += names[i];
+    }
+
+    return result.empty() ? "0" : result;
+}
+
+static uint32_t getStageBit(const Module &module)
+{
+    if(module.executionModel == EXECUTION_VERTEX) return 1;
+    if(module.executionModel == EXECUTION_FRAGMENT) return 2;
+    if(module.executionModel == EXECUTION_COMPUTE) return 4;
+
+    fail(module.path + " is not a vertex, fragment or compute shader");
+    return 0;
+}
+
+static std::string getDescriptorType(const Module &module, const Variable &variable, const Type &type)
+{
+    if(variable.storageClass == STORAGE_STORAGE_BUFFER) return "VK_DESCRIPTOR_TYPE_STORAGE_BUFFER";
+
+    if(variable.storageClass == STORAGE_UNIFORM)
+    {
+        if(type.bufferBlock) return "VK_DESCRIPTOR_TYPE_STORAGE_BUFFER";
+        return "VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER";
+    }
+
+    if(type.op == OP_TYPE_SAMPLED_IMAGE) return "VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER";
+    if(type.op == OP_TYPE_SAMPLER) return "VK_DESCRIPTOR_TYPE_SAMPLER";
+    if(type.op == OP_TYPE_IMAGE)
+    {
+        bool storage = type.imageSampled == 2;
+        if(type.imageDim == IMAGE_DIM_BUFFER)
+        { return storage ? "VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER" : "VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER"; }
+
+        return storage ? "VK_DESCRIPTOR_TYPE_STORAGE_IMAGE" : "VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE";
+    }
+
+    fail(module.path + " has a resource of unsupported type");
+    return "";
+}
+
+static std::string getFormat(const Module &module, const Type &type, uint32_t &size)
+{
+    const Type &component = type.op == OP_TYPE_VECTOR ? getType(module, type.element) : type;
+    uint32_t count = type.op == OP_TYPE_VECTOR ? type.count : 1;
+
+    if((component.op != OP_TYPE_FLOAT && component.op != OP_TYPE_INT) || component.width != 32)
+    { fail(module.path + " has a vertex input that is not 32-bit scalars or vectors"); }
+
+    const char *channels[] = {"R32", "R32G32", "R32G32B32", "R32G32B32A32"};
+    const char *suffix = component.op == OP_TYPE_FLOAT ? "_SFLOAT" : component.isSigned ? "_SINT" : "_UINT";
+
+    size = count * 4;
+
+    return std::string("VK_FORMAT_") + channels[count - 1] + suffix;
+}
+
+//the c++ type for a block member and its size, only layouts that match c++ and glm without padding
+static std::string getMemberType(const Module &module, const Member &member, const std::string &where,
+    uint32_t &size, std::string &arraySuffix)
+{
+    const Type *type = &getType(module, member.type);
+    uint32_t arrayLength = 0;
+    uint32_t arrayStride = 0;
+
+    if(type->op == OP_TYPE_ARRAY)
+    {
+        arrayLength = type->count;
+        arrayStride = type->arrayStride;
+        type = &getType(module, type->element);
+    }
+
+    std::string name;
+    uint32_t elementSize = 0;
+
+    if(type->op == OP_TYPE_FLOAT || type->op == OP_TYPE_INT)
+    {
+        if(type->width != 32) fail(where + " is not 32-bit");
+        name = type->op == OP_TYPE_FLOAT ? "float" : type->isSigned ? "int32_t" : "uint32_t";
+        elementSize = 4;
+    }
+    else if(type->op == OP_TYPE_VECTOR)
+    {
+        const Type &component = getType(module, type->element);
+        if(component.width != 32) fail(where + " is not 32-bit");
+        const char *prefix = component.op == OP_TYPE_FLOAT ? "vec" : component.isSigned ? "ivec" : "uvec";
+        name = "glm::" + std::string(prefix) + std::to_string(type->count);
+        elementSize = type->count * 4;
+    }
+    else if(type->op == OP_TYPE_MATRIX)
+    {
+        const Type &column = getType(module, type->element);
+        //glm keeps columns tightly packed, std140 pads them to 16 bytes
+        if(member.rowMajor || column.count != 4 || member.matrixStride != 16)
+        { fail(where + " needs column-major matrices with 4 rows"); }
+
+        name = type->count == 4 ? "glm::mat4" : "glm::mat" + std::to_string(type->count) + "x4";
+        elementSize = type->count * 16;
+    }
+    else
+    { fail(where + " has a type that cannot be written out"); }
+
+    size = elementSize;
+    arraySuffix.clear();
+
+    if(arrayLength > 0)
+    {
+        if(arrayStride != elementSize) fail(where + " is an array padded by std140, use 16 byte elements");
+
+        size = elementSize * arrayLength;
+        arraySuffix = "[" + std::to_string(arrayLength) + "]";
+    }
+
+    return name;
+}
+
+static void writeBlock(std::ostream &out, const Block &block)
+{
+    const Type &type = getType(*block.module, block.type);
+
+    //std140 rounds uniform blocks up to 16 bytes, push constants keep their exact size
+    out << "struct " << (block.uniform ? "alignas(16) " : "") << block.name << "\n{\n";
+
+    std::ostringstream asserts;
+    uint32_t end = 0;
+    uint32_t padding = 0;
+
+    for(const Member &member : type.members)
+    {
+        std::string where = block.name + "." + member.name;
+
+        if(member.offset < end) fail(where + " overlaps the member before it");
+
+        if(member.offset > end)
+        {
+            out << "    uint8_t padding" << padding++ << "[" << member.offset - end << "];\n";
+        }
+
+        uint32_t size = 0;
+        std::string arraySuffix;
+        std::string typeName = getMemberType(*block.module, member, where, size, arraySuffix);
+
+        out << "    " << typeName << " " << member.name << arraySuffix << ";\n";
+        asserts << "static_assert(offsetof(" << block.name << ", " << member.name << ") == " << member.offset
+            << ", \"" << where << " is not where the shader reads it\");\n";
+
+        end = member.offset + size;
+    }
+
+    uint32_t size = block.uniform ? (end + 15) / 16 * 16 : end;
+
+    out << "};\n\n" << asserts.str();
+    out << "static_assert(sizeof(" << block.name << ") == " << size << ", \"" << block.name
+        << " does not match the shader's size\");\n\n";
+}
+
+static uint32_t getBlockSize(const Module &module, uint32_t typeId)
+{
+    uint32_t end = 0;
+    for(const Member &member : getType(module, typeId).members)
+    {
+        uint32_t size = 0;
+        std::string arraySuffix;
+        getMemberType(module, member, module.path, size, arraySuffix);
+        end = std::max(end, member.offset + size);
+    }
+
+    return end;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 3)
+    {
+        std::cerr << "usage: reflect <output.h> <shader.spv>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<Module> modules;
+    for(int i = 2; i < argc; i++)
+    { modules.push_back(parse(argv[i])); }
+
+    std::map<uint32_t, Binding> bindings;
+    std::vector<Block> blocks;
+    std::vector<Attribute> attributes;
+    uint32_t pushConstantStages = 0;
+    uint32_t pushConstantSize = 0;
+    //by name, the same constant may be declared in several stages
+    std::map<std::string, uint32_t> specConstants;
+
+    for(const Module &module : modules)
+    {
+        uint32_t stage = getStageBit(module);
+
+        for(uint32_t id : module.specConstants)
+        {
+            auto found = module.decorations.find(id);
+            if(found == module.decorations.end() || !found->second.hasSpecId) continue;
+
+            std::string name = getName(module, id, "");
+            if(name.empty()) fail(module.path + " has an unnamed specialization constant");
+
+            uint32_t specId = found->second.specId;
+            for(const auto &existing : specConstants)
+            {
+                if((existing.first == name) != (existing.second == specId))
+                { fail(module.path + " specialization constant " + name + " clashes with another stage"); }
+            }
+
+            specConstants[name] = specId;
+        }
+
+        for(const Variable &variable : module.variables)
+        {
+            const Type &pointer = getType(module, variable.pointerType);
+            uint32_t typeId = pointer.element;
+            const Type *type = &getType(module, typeId);
+            auto found = module.decorations.find(variable.id);
+            Decorations decorations = found == module.decorations.end() ? Decorations() : found->second;
+
+            if(variable.storageClass == STORAGE_INPUT)
+            {
+                if(module.executionModel != EXECUTION_VERTEX || decorations.builtIn || !decorations.hasLocation)
+                { continue; }
+
+                Attribute attribute{};
+                attribute.location = decorations.location;
+                attribute.format = getFormat(module, *type, attribute.size);
+                attribute.name = getName(module, variable.id, "location" + std::to_string(attribute.location));
+                attributes.push_back(attribute);
+            }
+            else if(variable.storageClass == STORAGE_PUSH_CONSTANT)
+            {
+                std::string name = getName(module, typeId, "PushConstants");
+                bool seen = false;
+                for(const Block &block : blocks)
+                { seen = seen || block.name == name; }
+
+                if(!seen) blocks.push_back({name, &module, typeId, false});
+
+                pushConstantStages |= stage;
+                pushConstantSize = std::max(pushConstantSize, getBlockSize(module, typeId));
+            }
+            else if(variable.storageClass == STORAGE_UNIFORM || variable.storageClass == STORAGE_UNIFORM_CONSTANT
+                || variable.storageClass == STORAGE_STORAGE_BUFFER)
+            {
+                if(!decorations.hasBinding) continue;
+
+                std::string where = module.path + " binding " + std::to_string(decorations.binding);
+                if(decorations.set != 0) fail(where + " is not in set 0, the renderer binds one set");
+
+                uint32_t count = 1;
+                if(type->op == OP_TYPE_ARRAY)
+                {
+                    count = type->count;
+                    typeId = type->element;
+                    type = &getType(module, typeId);
+                }
+
+                Binding binding{};
+                binding.binding = decorations.binding;
+                binding.type = getDescriptorType(module, variable, *type);
+                binding.count = count;
+                binding.stages = stage;
+                binding.name = getName(module, variable.id, getName(module, typeId, "binding"));
+
+                auto existing = bindings.find(binding.binding);
+                if(existing != bindings.end())
+                {
+                    if(existing->second.type != binding.type || existing->second.count != binding.count)
+                    { fail(where + " is declared differently in another stage"); }
+
+                    existing->second.stages |= stage;
+                }
+                else bindings[binding.binding] = binding;
+
+                if(variable.storageClass == STORAGE_UNIFORM && type->block)
+                {
+                    std::string name = getName(module, typeId, binding.name);
+                    bool seen = false;
+                    for(const Block &block : blocks)
+                    { seen = seen || block.name == name; }
+
+                    if(!seen) blocks.push_back({name, &module, typeId, true});
+                }
+            }
+        }
+    }
+
+    std::ostringstream out;
+    out << "//generated by shaders/reflect.cpp from";
+    for(const Module &module : modules)
+    { out << " " << module.path; }
+    out << ", do not edit\n";
+    out << "#ifndef SHADER_LAYOUT_H\n#define SHADER_LAYOUT_H\n";
+    out << "#include <vulkan/vulkan.h>\n#include <vulkan/vulkan_core.h>\n#include <glm.hpp>\n";
+    out << "#include <stdint.h>\n#include <stddef.h>\n\n";
+
+    //tells which SPIR-V the header was made from
+    out << "constexpr uint64_t SHADER_LAYOUT_SPIRV_HASH = 0x" << std::hex << std::setw(16) << std::setfill('0')
+        << hashModules(modules) << std::dec << "ull;\n\n";
+
+    for(const Block &block : blocks)
+    { writeBlock(out, block); }
+
+    //descriptors, by binding
+    out << "constexpr uint32_t SHADER_DESCRIPTOR_BINDING_COUNT = " << bindings.size() << ";\n";
+    out << "constexpr VkDescriptorSetLayoutBinding SHADER_DESCRIPTOR_BINDINGS[] =\n{\n";
+    size_t index = 0;
+    for(const auto &entry : bindings)
+    {
+        const Binding &binding = entry.second;
+        out << "    {" << binding.binding << ", " << binding.type << ", " << binding.count << ", "
+            << getStageFlags(binding.stages) << ", nullptr}" << (++index < bindings.size() ? "," : "")
+            << " //" << binding.name << "\n";
+    }
+    out << "};\n\n";
+
+    //what one set takes from a pool, by type
+    std::vector<std::pair<std::string, uint32_t>> poolSizes;
+    for(const auto &entry : bindings)
+    {
+        bool merged = false;
+        for(auto &poolSize : poolSizes)
+        {
+            if(poolSize.first != entry.second.type) continue;
+
+            poolSize.second += entry.second.count;
+            merged = true;
+        }
+
+        if(!merged) poolSizes.push_back({entry.second.type, entry.second.count});
+    }
+
+    out << "constexpr uint32_t SHADER_POOL_SIZE_COUNT = " << poolSizes.size() << ";\n";
+    out << "constexpr VkDescriptorPoolSize SHADER_POOL_SIZES[] =\n{\n";
+    for(size_t i = 0; i < poolSizes.size(); i++)
+    {
+        out << "    {" << poolSizes[i].first << ", " << poolSizes[i].second << "}"
+            << (i + 1 < poolSizes.size() ? "," : "") << "\n";
+    }
+    out << "};\n\n";
+
+    out << "constexpr VkShaderStageFlags SHADER_PUSH_CONSTANT_STAGES = " << getStageFlags(pushConstantStages) << ";\n";
+    out << "constexpr uint32_t SHADER_PUSH_CONSTANT_SIZE = " << pushConstantSize << ";\n\n";
+
+    //ids to put in VkSpecializationMapEntry, by name
+    for(const auto &specConstant : specConstants)
+    { out << "constexpr uint32_t SHADER_SPEC_" << specConstant.first << " = " << specConstant.second << ";\n"; }
+    if(!specConstants.empty()) out << "\n";
+
+    //one interleaved binding, attributes packed in location order
+    std::sort(attributes.begin(), attributes.end(),
+        [](const Attribute &a, const Attribute &b){ return a.location < b.location; });
+
+    uint32_t offset = 0;
+    std::ostringstream attributeList;
+    for(size_t i = 0; i < attributes.size(); i++)
+    {
+        attributeList << "    {" << attributes[i].location << ", 0, " << attributes[i].format << ", " << offset << "}"
+            << (i + 1 < attributes.size() ? "," : "") << " //" << attributes[i].name << "\n";
+        offset += attributes[i].size;
+    }
+
+    out << "constexpr uint32_t SHADER_VERTEX_STRIDE = " << offset << ";\n";
+    out << "constexpr uint32_t SHADER_VERTEX_ATTRIBUTE_COUNT = " << attributes.size() << ";\n";
+    out << "constexpr VkVertexInputAttributeDescription SHADER_VERTEX_ATTRIBUTES[] =\n{\n";
+    out << attributeList.str() << "};\n\n";
+
+    out << "#endif\n";
+
+    //left alone when nothing changed so everything including it is not rebuilt
+    std::ifstream previous(argv[1], std::ios::binary);
+    std::stringstream previousContents;
+    previousContents << previous.rdbuf();
+    if(previous.is_open() && previousContents.str() == out.str()) return 0;
+
+    std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+    file << out.str();
+    if(!file) fail("failed to write " + std::string(argv[1]));
+
+    return 0;
+}
@@ -1,5 +1,10 @@
 #version 450
 
+//set per pipeline variant, branches on them are compiled out
+layout(constant_id = 0) const bool ALPHA_TEST = false;
+layout(constant_id = 1) const bool TEXTURED = true;
+layout(constant_id = 2) const bool VERTEX_COLOR = false;
+
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 
@@ -8,5 +13,11 @@ layout(location = 0) out vec4 outColor;
 layout(binding = 1) uniform sampler2D texSampler;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
+    vec4 color = TEXTURED ? texture(texSampler, fragTexCoord) : vec4(1.0);
+
+    if(VERTEX_COLOR) color.rgb *= fragColor;
+
+    if(ALPHA_TEST && color.a < 0.5) discard;
+
+    outColor = color;
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+//generated by shaders/reflect.cpp from vert.spv frag.spv, do not edit
+#ifndef SHADER_LAYOUT_H
+#define SHADER_LAYOUT_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#include <glm.hpp>
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr uint64_t SHADER_LAYOUT_SPIRV_HASH = 0xc2c44e838ea714d0ull;
+
+struct alignas(16) UniformBufferObject
+{
+    glm::mat4 view;
+    glm::mat4 proj;
+};
+
+static_assert(offsetof(UniformBufferObject, view) == 0, "UniformBufferObject.view is not where the shader reads it");
+static_assert(offsetof(UniformBufferObject, proj) == 64, "UniformBufferObject.proj is not where the shader reads it");
+static_assert(sizeof(UniformBufferObject) == 128, "UniformBufferObject does not match the shader's size");
+
+struct ObjectPushConstants
+{
+    glm::mat4 model;
+    uint32_t objectIndex;
+};
+
+static_assert(offsetof(ObjectPushConstants, model) == 0, "ObjectPushConstants.model is not where the shader reads it");
+static_assert(offsetof(ObjectPushConstants, objectIndex) == 64, "ObjectPushConstants.objectIndex is not where the shader reads it");
+static_assert(sizeof(ObjectPushConstants) == 68, "ObjectPushConstants does not match the shader's size");
+
+constexpr uint32_t SHADER_DESCRIPTOR_BINDING_COUNT = 2;
+constexpr VkDescriptorSetLayoutBinding SHADER_DESCRIPTOR_BINDINGS[] =
+{
+    {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr}, //ubo
+    {1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr} //texSampler
+};
+
+constexpr uint32_t SHADER_POOL_SIZE_COUNT = 2;
+constexpr VkDescriptorPoolSize SHADER_POOL_SIZES[] =
+{
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1}
+};
+
+constexpr VkShaderStageFlags SHADER_PUSH_CONSTANT_STAGES = VK_SHADER_STAGE_VERTEX_BIT;
+constexpr uint32_t SHADER_PUSH_CONSTANT_SIZE = 68;
+
+constexpr uint32_t SHADER_SPEC_ALPHA_TEST = 0;
+constexpr uint32_t SHADER_SPEC_TEXTURED = 1;
+constexpr uint32_t SHADER_SPEC_VERTEX_COLOR = 2;
+
+constexpr uint32_t SHADER_VERTEX_STRIDE = 32;
+constexpr uint32_t SHADER_VERTEX_ATTRIBUTE_COUNT = 3;
+constexpr VkVertexInputAttributeDescription SHADER_VERTEX_ATTRIBUTES[] =
+{
+    {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0}, //inPosition
+    {1, 0, VK_FORMAT_R32G32B32_SFLOAT, 12}, //inColor
+    {2, 0, VK_FORMAT_R32G32_SFLOAT, 24} //inTexCoord
+};
+
+#endif
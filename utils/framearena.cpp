@@ -0,0 +1,45 @@
+#include <framearena.h>
+#include <stdexcept>
+#include <cstdlib>
+#include <algorithm>
+
+void FrameArena::create(size_t capacity)
+{
+    memory = static_cast<uint8_t*>(std::malloc(capacity));
+
+    if(memory == nullptr)
+    { throw std::runtime_error("failed to allocate frame arena"); }
+
+    this->capacity = capacity;
+    head = 0;
+    highWater = 0;
+}
+
+void FrameArena::destroy()
+{
+    std::free(memory);
+
+    memory = nullptr;
+    capacity = 0;
+    head = 0;
+}
+
+void FrameArena::reset()
+{
+    head = 0;
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(memory);
+    uintptr_t aligned = (base + head + alignment - 1) / alignment * alignment;
+    size_t offset = static_cast<size_t>(aligned - base);
+
+    if(offset + size > capacity)
+    { throw std::runtime_error("frame arena exhausted"); }
+
+    head = offset + size;
+    highWater = std::max(highWater, head);
+
+    return memory + offset;
+}
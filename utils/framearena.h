@@ -0,0 +1,80 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+//Bump allocator for data that only lives for one frame. Everything handed out
+//is released at once by reset(), individual frees do nothing.
+class FrameArena
+{
+    public:
+        void create(size_t capacity);
+
+        void destroy();
+
+        //call once the frame that used this arena has finished
+        void reset();
+
+        void* allocate(size_t size, size_t alignment);
+
+        template<typename T>
+        T* allocate(size_t count)
+        { return static_cast<T*>(allocate(sizeof(T) * count, alignof(T))); }
+
+        size_t getUsed() const
+        { return head; }
+
+        size_t getCapacity() const
+        { return capacity; }
+
+        size_t getHighWater() const
+        { return highWater; }
+
+    private:
+        uint8_t *memory = nullptr;
+        size_t capacity = 0;
+        size_t head = 0;
+        size_t highWater = 0;
+};
+
+//Lets standard containers draw from a FrameArena. The container must not outlive
+//the arena's next reset.
+template<typename T>
+class ArenaAllocator
+{
+    public:
+        typedef T value_type;
+
+        ArenaAllocator(FrameArena &arena) : arena(&arena)
+        {}
+
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.getArena())
+        {}
+
+        T* allocate(size_t count)
+        { return arena->allocate<T>(count); }
+
+        void deallocate(T*, size_t)
+        {}
+
+        FrameArena* getArena() const
+        { return arena; }
+
+    private:
+        FrameArena *arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{ return a.getArena() == b.getArena(); }
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{ return a.getArena() != b.getArena(); }
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
@@ -0,0 +1,135 @@
+#include <framelimiter.h>
+#include <thread>
+#include <algorithm>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+//older mingw headers leave it out
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+FrameLimiter::~FrameLimiter()
+{
+#ifdef _WIN32
+    if(timer != nullptr)
+    { CloseHandle(timer); }
+#endif
+}
+
+void FrameLimiter::setTargetFrameTime(double seconds)
+{
+    targetFrameTime = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(0.0, seconds)));
+}
+
+void FrameLimiter::setSpinThreshold(double seconds)
+{
+    spinThreshold = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(0.0, seconds)));
+}
+
+void FrameLimiter::wait()
+{
+    if(!started)
+    {
+        lastFrameStart = Clock::now();
+        started = true;
+        return;
+    }
+
+    if(targetFrameTime > Clock::duration::zero())
+    {
+        Clock::time_point deadline = lastFrameStart + targetFrameTime;
+        Clock::time_point now = Clock::now();
+
+        Clock::duration spin = std::max(spinThreshold, sleepOvershoot);
+
+        if(deadline - now > spin)
+        {
+            Clock::time_point wake = deadline - spin;
+            sleep(wake - now);
+
+            Clock::duration overshoot = Clock::now() - wake;
+            sleepOvershoot = std::max(overshoot, sleepOvershoot - sleepOvershoot / 16);
+        }
+
+        while(Clock::now() < deadline)
+        { std::this_thread::yield(); }
+    }
+
+    Clock::time_point frameStart = Clock::now();
+
+    frameTimes[nextFrameTime] = std::chrono::duration<double, std::milli>(frameStart - lastFrameStart).count();
+    nextFrameTime = (nextFrameTime + 1) % WINDOW_SIZE;
+    if(frameTimeCount < WINDOW_SIZE)
+    { frameTimeCount++; }
+
+    //pace from the deadline when we are on time so sleep overshoot doesn't accumulate
+    Clock::time_point deadline = lastFrameStart + targetFrameTime;
+    if(targetFrameTime > Clock::duration::zero() && frameStart - deadline < targetFrameTime)
+    { lastFrameStart = deadline; }
+    else
+    { lastFrameStart = frameStart; }
+}
+
+void FrameLimiter::sleep(Clock::duration duration)
+{
+#ifdef _WIN32
+    //windows 10 1803 and later, older versions fall back to sleep_for
+    if(!timerCreated)
+    {
+        timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        timerCreated = true;
+    }
+
+    if(timer != nullptr)
+    {
+        //negative is relative, in 100 ns units
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / 100);
+
+        if(SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE))
+        {
+            WaitForSingleObject(timer, INFINITE);
+            return;
+        }
+    }
+#endif
+
+    std::this_thread::sleep_for(duration);
+}
+
+FrameTimeStats FrameLimiter::getStats() const
+{
+    FrameTimeStats stats{};
+
+    if(frameTimeCount == 0) return stats;
+
+    stats.minMs = frameTimes[0];
+    stats.maxMs = frameTimes[0];
+
+    double sum = 0.0;
+    for(size_t i = 0; i < frameTimeCount; i++)
+    {
+        sum += frameTimes[i];
+        stats.minMs = std::min(stats.minMs, frameTimes[i]);
+        stats.maxMs = std::max(stats.maxMs, frameTimes[i]);
+    }
+
+    stats.meanMs = sum / frameTimeCount;
+
+    double squares = 0.0;
+    for(size_t i = 0; i < frameTimeCount; i++)
+    {
+        double difference = frameTimes[i] - stats.meanMs;
+        squares += difference * difference;
+    }
+
+    stats.varianceMs = squares / frameTimeCount;
+
+    return stats;
+}
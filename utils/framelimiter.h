@@ -0,0 +1,64 @@
+#ifndef FRAME_LIMITER_H
+#define FRAME_LIMITER_H
+#include <chrono>
+#include <array>
+#include <cstddef>
+
+struct FrameTimeStats
+{
+    double meanMs;
+    //in ms squared
+    double varianceMs;
+    double minMs;
+    double maxMs;
+};
+
+//Caps the frame rate by sleeping most of the remaining frame time and spinning
+//the last part, since OS sleeps overshoot by up to a scheduler tick. On Windows
+//the sleep is a high resolution waitable timer rather than the ~15.6 ms tick,
+//and everywhere the spin grows to cover the overshoot sleeps are measured at.
+//Also keeps a window of recent frame times.
+class FrameLimiter
+{
+    public:
+        //0 disables the cap, frame times are still measured
+        void setTargetFrameTime(double seconds);
+
+        double getTargetFrameTime() const
+        { return std::chrono::duration<double>(targetFrameTime).count(); }
+
+        //how early to stop sleeping and start spinning at least
+        void setSpinThreshold(double seconds);
+
+        //blocks until the next frame may start, call once per frame
+        void wait();
+
+        FrameTimeStats getStats() const;
+
+        ~FrameLimiter();
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        static const size_t WINDOW_SIZE = 128;
+
+        Clock::duration targetFrameTime = Clock::duration::zero();
+        Clock::duration spinThreshold = std::chrono::microseconds(2000);
+        //recent worst sleep overshoot, decaying so one bad wake does not spin forever
+        Clock::duration sleepOvershoot = Clock::duration::zero();
+
+        //a HANDLE, null when not created or not supported
+        void *timer = nullptr;
+        bool timerCreated = false;
+
+        Clock::time_point lastFrameStart;
+        bool started = false;
+
+        std::array<double, WINDOW_SIZE> frameTimes{};
+        size_t frameTimeCount = 0;
+        size_t nextFrameTime = 0;
+
+        void sleep(Clock::duration duration);
+};
+
+#endif
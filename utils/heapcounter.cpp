@@ -0,0 +1,67 @@
+#include <heapcounter.h>
+#include <new>
+#include <cstdlib>
+#include <atomic>
+
+//shared, frames are recorded and updated on several threads
+static std::atomic<uint64_t> heapAllocations{0};
+static thread_local bool ignored = false;
+
+uint64_t getHeapAllocationCount()
+{
+    return heapAllocations.load(std::memory_order_relaxed);
+}
+
+void ignoreHeapAllocations()
+{
+    ignored = true;
+}
+
+void* operator new(std::size_t size)
+{
+    if(!ignored) heapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    void *memory = std::malloc(size == 0 ? 1 : size);
+
+    if(memory == nullptr)
+    { throw std::bad_alloc(); }
+
+    return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    if(!ignored) heapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
@@ -0,0 +1,13 @@
+#ifndef HEAP_COUNTER_H
+#define HEAP_COUNTER_H
+#include <cstdint>
+
+//Number of global operator new calls made so far, by every thread that has not
+//opted out. Sample it before and after a piece of work to see whether it touched the heap.
+uint64_t getHeapAllocationCount();
+
+//leaves the calling thread out of the count, for background workers whose
+//allocations belong to no frame
+void ignoreHeapAllocations();
+
+#endif
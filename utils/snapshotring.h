@@ -0,0 +1,62 @@
+#ifndef SNAPSHOT_RING_H
+#define SNAPSHOT_RING_H
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+//Lock-free hand-off of whole snapshots from one producer thread to one consumer
+//thread. The consumer always takes the newest published snapshot and skips the
+//rest, the producer can run at most depth snapshots ahead of the one being read.
+template<typename T>
+class SnapshotRing
+{
+    public:
+        //not thread safe, call before either side starts
+        void create(uint32_t depth)
+        {
+            slots.clear();
+            slots.resize(depth + 1);
+            published.store(0, std::memory_order_relaxed);
+            reading.store(0, std::memory_order_relaxed);
+        }
+
+        //producer: slot to fill, or nullptr while the ring is full
+        T* beginWrite()
+        {
+            uint64_t next = published.load(std::memory_order_relaxed);
+
+            if(next - reading.load(std::memory_order_acquire) >= slots.size()) return nullptr;
+
+            return &slots[next % slots.size()];
+        }
+
+        //producer: makes the slot from beginWrite visible to the consumer
+        void endWrite()
+        { published.fetch_add(1, std::memory_order_release); }
+
+        //consumer: newest snapshot, or nullptr before the first one is published
+        //stays valid and untouched by the producer until the next call
+        const T* acquireLatest()
+        {
+            uint64_t count = published.load(std::memory_order_acquire);
+
+            if(count == 0) return nullptr;
+
+            //releases everything older, the producer may reuse those slots now
+            reading.store(count - 1, std::memory_order_release);
+
+            return &slots[(count - 1) % slots.size()];
+        }
+
+        uint32_t getDepth() const
+        { return static_cast<uint32_t>(slots.size() - 1); }
+
+    private:
+        std::vector<T> slots;
+        //snapshots published so far, the next write goes to published % size
+        std::atomic<uint64_t> published{0};
+        //index of the snapshot the consumer holds
+        std::atomic<uint64_t> reading{0};
+};
+
+#endif
@@ -0,0 +1,343 @@
+#include <vkallocator.h>
+#include <vkhelpers.h>
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void DeviceAllocator::init(VkDevice &device, VkPhysicalDevice &physicalDevice, VkDeviceSize blockSize)
+{
+    this->device = device;
+    this->physicalDevice = physicalDevice;
+    this->blockSize = blockSize;
+
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+}
+
+void DeviceAllocator::destroy()
+{
+    for(Block &block : blocks)
+    {
+        if(block.memory != VK_NULL_HANDLE)
+        { vkFreeMemory(device, block.memory, nullptr); }
+    }
+
+    blocks.clear();
+    entries.clear();
+    freeEntries.clear();
+}
+
+uint32_t DeviceAllocator::createBlock(uint32_t memoryTypeIndex, bool linear, VkDeviceSize size)
+{
+    Block block{};
+    block.memoryTypeIndex = memoryTypeIndex;
+    block.linear = linear;
+    block.size = size;
+    block.used = 0;
+    block.allocationCount = 0;
+    block.mapped = nullptr;
+    block.freeRanges[0] = size;
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    if(vkAllocateMemory(device, &allocInfo, nullptr, &block.memory) != VK_SUCCESS)
+    { throw std::runtime_error("failed to allocate memory block"); }
+
+    //host visible blocks stay mapped for their whole life, ranges are handed out as pointers
+    if(memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        void *data;
+        vkMapMemory(device, block.memory, 0, VK_WHOLE_SIZE, 0, &data);
+        block.mapped = static_cast<uint8_t*>(data);
+    }
+
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        if(blocks[i].memory == VK_NULL_HANDLE)
+        {
+            blocks[i] = block;
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    blocks.push_back(block);
+
+    return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+bool DeviceAllocator::allocateFromBlock(uint32_t blockIndex, VkDeviceSize size,
+    VkDeviceSize alignment, VkDeviceSize &offset)
+{
+    Block &block = blocks[blockIndex];
+
+    for(auto it = block.freeRanges.begin(); it != block.freeRanges.end(); it++)
+    {
+        VkDeviceSize rangeOffset = it->first;
+        VkDeviceSize rangeSize = it->second;
+        VkDeviceSize alignedOffset = alignUp(rangeOffset, alignment);
+
+        if(alignedOffset + size > rangeOffset + rangeSize) continue;
+
+        block.freeRanges.erase(it);
+
+        if(alignedOffset > rangeOffset)
+        { block.freeRanges[rangeOffset] = alignedOffset - rangeOffset; }
+
+        VkDeviceSize end = alignedOffset + size;
+        if(end < rangeOffset + rangeSize)
+        { block.freeRanges[end] = rangeOffset + rangeSize - end; }
+
+        block.used += size;
+        block.allocationCount++;
+        offset = alignedOffset;
+
+        return true;
+    }
+
+    return false;
+}
+
+void DeviceAllocator::freeRange(uint32_t blockIndex, VkDeviceSize offset, VkDeviceSize size)
+{
+    Block &block = blocks[blockIndex];
+
+    block.used -= size;
+    block.allocationCount--;
+
+    auto it = block.freeRanges.emplace(offset, size).first;
+
+    auto next = std::next(it);
+    if(next != block.freeRanges.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        block.freeRanges.erase(next);
+    }
+
+    if(it != block.freeRanges.begin())
+    {
+        auto previous = std::prev(it);
+        if(previous->first + previous->second == it->first)
+        {
+            previous->second += it->second;
+            block.freeRanges.erase(it);
+        }
+    }
+}
+
+uint32_t DeviceAllocator::newEntry()
+{
+    if(!freeEntries.empty())
+    {
+        uint32_t index = freeEntries.back();
+        freeEntries.pop_back();
+        entries[index] = Entry{};
+        return index;
+    }
+
+    entries.push_back(Entry{});
+
+    return static_cast<uint32_t>(entries.size() - 1);
+}
+
+uint32_t DeviceAllocator::allocate(const VkMemoryRequirements &requirements,
+    VkMemoryPropertyFlags properties, bool linear)
+{
+    uint32_t memoryTypeIndex = findMemoryType(physicalDevice,
+        requirements.memoryTypeBits, properties);
+
+    uint32_t blockIndex = UINT32_MAX;
+    VkDeviceSize offset = 0;
+
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        if(blocks[i].memory == VK_NULL_HANDLE || blocks[i].memoryTypeIndex != memoryTypeIndex
+            || blocks[i].linear != linear) continue;
+
+        if(allocateFromBlock(static_cast<uint32_t>(i), requirements.size, requirements.alignment, offset))
+        {
+            blockIndex = static_cast<uint32_t>(i);
+            break;
+        }
+    }
+
+    if(blockIndex == UINT32_MAX)
+    {
+        blockIndex = createBlock(memoryTypeIndex, linear, std::max(blockSize, requirements.size));
+
+        if(!allocateFromBlock(blockIndex, requirements.size, requirements.alignment, offset))
+        { throw std::runtime_error("failed to sub-allocate from new memory block"); }
+    }
+
+    uint32_t allocation = newEntry();
+    Entry &entry = entries[allocation];
+    entry.live = true;
+    entry.block = blockIndex;
+    entry.offset = offset;
+    entry.size = requirements.size;
+    entry.alignment = requirements.alignment;
+    entry.properties = properties;
+    entry.movable = !(properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
+    return allocation;
+}
+
+bool DeviceAllocator::allocateElsewhere(Entry source, uint32_t excludeBlock, uint32_t &allocation)
+{
+    const Block &sourceBlock = blocks[source.block];
+
+    //fullest blocks first so live data packs together
+    std::vector<uint32_t> candidates;
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        if(i == excludeBlock || blocks[i].memory == VK_NULL_HANDLE
+            || blocks[i].memoryTypeIndex != sourceBlock.memoryTypeIndex
+            || blocks[i].linear != sourceBlock.linear) continue;
+
+        candidates.push_back(static_cast<uint32_t>(i));
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b)
+    { return blocks[a].used > blocks[b].used; });
+
+    for(uint32_t blockIndex : candidates)
+    {
+        VkDeviceSize offset;
+        if(allocateFromBlock(blockIndex, source.size, source.alignment, offset))
+        {
+            allocation = newEntry();
+            Entry &entry = entries[allocation];
+            entry.live = true;
+            entry.block = blockIndex;
+            entry.offset = offset;
+            entry.size = source.size;
+            entry.alignment = source.alignment;
+            entry.properties = source.properties;
+            entry.movable = source.movable;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void DeviceAllocator::free(uint32_t allocation)
+{
+    Entry &entry = entries[allocation];
+
+    if(!entry.live) return;
+
+    freeRange(entry.block, entry.offset, entry.size);
+
+    entry.live = false;
+    freeEntries.push_back(allocation);
+}
+
+void DeviceAllocator::registerBuffer(uint32_t allocation, VkBuffer buffer,
+    const VkBufferCreateInfo &bufferInfo)
+{
+    Entry &entry = entries[allocation];
+    entry.buffer = buffer;
+    entry.bufferInfo = bufferInfo;
+    entry.bufferInfo.pNext = nullptr;
+    entry.bufferInfo.pQueueFamilyIndices = nullptr;
+    entry.bufferInfo.queueFamilyIndexCount = 0;
+}
+
+void DeviceAllocator::registerImage(uint32_t allocation, VkImage image,
+    const VkImageCreateInfo &imageInfo, VkImageAspectFlags aspectFlags)
+{
+    Entry &entry = entries[allocation];
+    entry.image = image;
+    entry.imageInfo = imageInfo;
+    entry.imageInfo.pNext = nullptr;
+    entry.imageInfo.pQueueFamilyIndices = nullptr;
+    entry.imageInfo.queueFamilyIndexCount = 0;
+    entry.aspectFlags = aspectFlags;
+}
+
+void DeviceAllocator::setImageLayout(uint32_t allocation, VkImageLayout layout)
+{
+    entries[allocation].layout = layout;
+}
+
+VkDeviceMemory DeviceAllocator::getMemory(uint32_t allocation) const
+{
+    return blocks[entries[allocation].block].memory;
+}
+
+VkDeviceSize DeviceAllocator::getOffset(uint32_t allocation) const
+{
+    return entries[allocation].offset;
+}
+
+VkDeviceSize DeviceAllocator::getSize(uint32_t allocation) const
+{
+    return entries[allocation].size;
+}
+
+void* DeviceAllocator::getMapped(uint32_t allocation) const
+{
+    const Entry &entry = entries[allocation];
+    const Block &block = blocks[entry.block];
+
+    if(block.mapped == nullptr)
+    { throw std::runtime_error("allocation is not host visible"); }
+
+    return block.mapped + entry.offset;
+}
+
+uint32_t DeviceAllocator::releaseEmptyBlocks()
+{
+    uint32_t released = 0;
+
+    for(Block &block : blocks)
+    {
+        if(block.memory == VK_NULL_HANDLE || block.allocationCount > 0) continue;
+
+        vkFreeMemory(device, block.memory, nullptr);
+        block.memory = VK_NULL_HANDLE;
+        block.mapped = nullptr;
+        block.freeRanges.clear();
+        released++;
+    }
+
+    return released;
+}
+
+AllocatorStats DeviceAllocator::getStats() const
+{
+    AllocatorStats stats{};
+
+    for(const Block &block : blocks)
+    {
+        if(block.memory == VK_NULL_HANDLE) continue;
+
+        stats.blockCount++;
+        stats.allocationCount += block.allocationCount;
+        stats.blockBytes += block.size;
+        stats.usedBytes += block.used;
+
+        for(const auto &range : block.freeRanges)
+        {
+            stats.freeBytes += range.second;
+            stats.largestFreeRange = std::max(stats.largestFreeRange, range.second);
+            stats.freeRangeCount++;
+        }
+    }
+
+    if(stats.freeBytes > 0)
+    {
+        stats.fragmentation = 1.0f - static_cast<float>(stats.largestFreeRange)
+            / static_cast<float>(stats.freeBytes);
+    }
+
+    return stats;
+}
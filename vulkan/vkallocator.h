@@ -0,0 +1,117 @@
+#ifndef VK_ALLOCATOR_H
+#define VK_ALLOCATOR_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <vector>
+#include <map>
+
+struct AllocatorStats
+{
+    uint32_t blockCount;
+    uint32_t allocationCount;
+    VkDeviceSize blockBytes;
+    VkDeviceSize usedBytes;
+    VkDeviceSize freeBytes;
+    VkDeviceSize largestFreeRange;
+    uint32_t freeRangeCount;
+    //0 when all free space is one range, close to 1 when it is scattered
+    float fragmentation;
+};
+
+//Sub-allocates buffers and images out of large VkDeviceMemory blocks instead of
+//one vkAllocateMemory per resource. Allocations are referred to by id so the
+//defragmenter can move them without invalidating what the caller holds.
+class DeviceAllocator
+{
+    public:
+        void init(VkDevice &device, VkPhysicalDevice &physicalDevice, VkDeviceSize blockSize);
+
+        void destroy();
+
+        uint32_t allocate(const VkMemoryRequirements &requirements,
+            VkMemoryPropertyFlags properties, bool linear);
+
+        void free(uint32_t allocation);
+
+        void registerBuffer(uint32_t allocation, VkBuffer buffer, const VkBufferCreateInfo &bufferInfo);
+
+        void registerImage(uint32_t allocation, VkImage image, const VkImageCreateInfo &imageInfo,
+            VkImageAspectFlags aspectFlags);
+
+        //images are only moved while they rest in a known layout
+        void setImageLayout(uint32_t allocation, VkImageLayout layout);
+
+        VkDeviceMemory getMemory(uint32_t allocation) const;
+        VkDeviceSize getOffset(uint32_t allocation) const;
+        VkDeviceSize getSize(uint32_t allocation) const;
+        void* getMapped(uint32_t allocation) const;
+
+        VkBuffer getBuffer(uint32_t allocation) const
+        { return entries[allocation].buffer; }
+
+        VkImage getImage(uint32_t allocation) const
+        { return entries[allocation].image; }
+
+        uint32_t releaseEmptyBlocks();
+
+        AllocatorStats getStats() const;
+
+    private:
+        friend class Defragmenter;
+
+        struct Block
+        {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            uint32_t memoryTypeIndex;
+            bool linear;
+            VkDeviceSize size;
+            VkDeviceSize used;
+            uint32_t allocationCount;
+            uint8_t *mapped;
+            //offset -> size, kept coalesced
+            std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+        };
+
+        struct Entry
+        {
+            bool live = false;
+            uint32_t block;
+            VkDeviceSize offset;
+            VkDeviceSize size;
+            VkDeviceSize alignment;
+            VkMemoryPropertyFlags properties;
+            bool movable;
+
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkBufferCreateInfo bufferInfo{};
+
+            VkImage image = VK_NULL_HANDLE;
+            VkImageCreateInfo imageInfo{};
+            VkImageAspectFlags aspectFlags;
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        };
+
+        VkDevice device = VK_NULL_HANDLE;
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        VkDeviceSize blockSize = 0;
+        VkPhysicalDeviceMemoryProperties memoryProperties{};
+
+        std::vector<Block> blocks;
+        std::vector<Entry> entries;
+        std::vector<uint32_t> freeEntries;
+
+        bool allocateFromBlock(uint32_t blockIndex, VkDeviceSize size, VkDeviceSize alignment,
+            VkDeviceSize &offset);
+
+        void freeRange(uint32_t blockIndex, VkDeviceSize offset, VkDeviceSize size);
+
+        uint32_t createBlock(uint32_t memoryTypeIndex, bool linear, VkDeviceSize size);
+
+        uint32_t newEntry();
+
+        //places an allocation in an existing block other than excludeBlock, or fails
+        bool allocateElsewhere(Entry source, uint32_t excludeBlock, uint32_t &allocation);
+};
+
+#endif
@@ -0,0 +1,380 @@
+#include <vkdefrag.h>
+#include <algorithm>
+#include <array>
+#include <utility>
+
+void Defragmenter::init(DeviceAllocator *allocator, VkDeviceSize bytesPerFrame, float maxBlockUsage)
+{
+    this->allocator = allocator;
+    this->bytesPerFrame = bytesPerFrame;
+    this->maxBlockUsage = maxBlockUsage;
+}
+
+bool Defragmenter::isPending(uint32_t allocation) const
+{
+    for(const PendingMove &move : pendingMoves)
+    {
+        if(move.source == allocation || move.destination == allocation)
+        { return true; }
+    }
+
+    return false;
+}
+
+uint32_t Defragmenter::pickSourceBlock()
+{
+    const std::vector<DeviceAllocator::Block> &blocks = allocator->blocks;
+    const std::vector<DeviceAllocator::Entry> &entries = allocator->entries;
+
+    uint32_t best = UINT32_MAX;
+    float bestUsage = maxBlockUsage;
+
+    for(size_t b = 0; b < blocks.size(); b++)
+    {
+        const DeviceAllocator::Block &block = blocks[b];
+
+        if(block.memory == VK_NULL_HANDLE || block.allocationCount == 0) continue;
+        if(std::find(skippedBlocks.begin(), skippedBlocks.end(), b) != skippedBlocks.end()) continue;
+
+        float usage = static_cast<float>(block.used) / static_cast<float>(block.size);
+        if(usage >= bestUsage) continue;
+
+        //only worth emptying when a sibling block can take the data
+        bool hasSibling = false;
+        for(size_t other = 0; other < blocks.size(); other++)
+        {
+            if(other != b && blocks[other].memory != VK_NULL_HANDLE
+                && blocks[other].memoryTypeIndex == block.memoryTypeIndex
+                && blocks[other].linear == block.linear)
+            {
+                hasSibling = true;
+                break;
+            }
+        }
+
+        if(!hasSibling) continue;
+
+        bool movable = true;
+        for(const DeviceAllocator::Entry &entry : entries)
+        {
+            if(!entry.live || entry.block != b) continue;
+
+            bool hasResource = entry.buffer != VK_NULL_HANDLE
+                || (entry.image != VK_NULL_HANDLE && entry.layout != VK_IMAGE_LAYOUT_UNDEFINED);
+
+            if(!entry.movable || !hasResource)
+            {
+                movable = false;
+                break;
+            }
+        }
+
+        if(!movable) continue;
+
+        best = static_cast<uint32_t>(b);
+        bestUsage = usage;
+    }
+
+    return best;
+}
+
+bool Defragmenter::createDestination(uint32_t source, uint32_t &destination)
+{
+    VkDevice device = allocator->device;
+    DeviceAllocator::Entry entry = allocator->entries[source];
+
+    if(!allocator->allocateElsewhere(entry, entry.block, destination))
+    { return false; }
+
+    VkDeviceMemory memory = allocator->getMemory(destination);
+    VkDeviceSize offset = allocator->getOffset(destination);
+    VkMemoryRequirements requirements;
+
+    if(entry.buffer != VK_NULL_HANDLE)
+    {
+        VkBuffer buffer;
+        if(vkCreateBuffer(device, &entry.bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+        {
+            allocator->free(destination);
+            return false;
+        }
+
+        vkGetBufferMemoryRequirements(device, buffer, &requirements);
+        if(requirements.size > entry.size || offset % requirements.alignment != 0)
+        {
+            vkDestroyBuffer(device, buffer, nullptr);
+            allocator->free(destination);
+            return false;
+        }
+
+        vkBindBufferMemory(device, buffer, memory, offset);
+        allocator->registerBuffer(destination, buffer, entry.bufferInfo);
+    }
+    else
+    {
+        VkImage image;
+        if(vkCreateImage(device, &entry.imageInfo, nullptr, &image) != VK_SUCCESS)
+        {
+            allocator->free(destination);
+            return false;
+        }
+
+        vkGetImageMemoryRequirements(device, image, &requirements);
+        if(requirements.size > entry.size || offset % requirements.alignment != 0)
+        {
+            vkDestroyImage(device, image, nullptr);
+            allocator->free(destination);
+            return false;
+        }
+
+        vkBindImageMemory(device, image, memory, offset);
+        allocator->registerImage(destination, image, entry.imageInfo, entry.aspectFlags);
+        allocator->setImageLayout(destination, entry.layout);
+    }
+
+    return true;
+}
+
+void Defragmenter::recordCopy(VkCommandBuffer commandBuffer, uint32_t source, uint32_t destination)
+{
+    const DeviceAllocator::Entry &from = allocator->entries[source];
+    const DeviceAllocator::Entry &to = allocator->entries[destination];
+
+    if(from.buffer != VK_NULL_HANDLE)
+    {
+        VkBufferCopy copyRegion{};
+        copyRegion.size = from.bufferInfo.size;
+        vkCmdCopyBuffer(commandBuffer, from.buffer, to.buffer, 1, &copyRegion);
+        return;
+    }
+
+    std::array<VkImageMemoryBarrier, 2> barriers{};
+    for(VkImageMemoryBarrier &barrier : barriers)
+    {
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = from.aspectFlags;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = from.imageInfo.mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = from.imageInfo.arrayLayers;
+    }
+
+    barriers[0].image = from.image;
+    barriers[0].oldLayout = from.layout;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    barriers[1].image = to.image;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].srcAccessMask = 0;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    std::vector<VkImageCopy> regions(from.imageInfo.mipLevels);
+    for(uint32_t mip = 0; mip < from.imageInfo.mipLevels; mip++)
+    {
+        VkImageCopy &region = regions[mip];
+        region = {};
+        region.srcSubresource.aspectMask = from.aspectFlags;
+        region.srcSubresource.mipLevel = mip;
+        region.srcSubresource.baseArrayLayer = 0;
+        region.srcSubresource.layerCount = from.imageInfo.arrayLayers;
+        region.dstSubresource = region.srcSubresource;
+        region.extent.width = std::max(1u, from.imageInfo.extent.width >> mip);
+        region.extent.height = std::max(1u, from.imageInfo.extent.height >> mip);
+        region.extent.depth = std::max(1u, from.imageInfo.extent.depth >> mip);
+    }
+
+    vkCmdCopyImage(commandBuffer, from.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        to.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()), regions.data());
+
+    //both go back to the resting layout, the old image is still used by this frame
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].newLayout = from.layout;
+    barriers[0].srcAccessMask = 0;
+    barriers[0].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].newLayout = from.layout;
+    barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+}
+
+void Defragmenter::recordMoves(VkCommandBuffer commandBuffer, uint64_t frameNumber)
+{
+    if(sourceBlock != UINT32_MAX && allocator->blocks[sourceBlock].memory == VK_NULL_HANDLE)
+    { sourceBlock = UINT32_MAX; }
+
+    if(sourceBlock == UINT32_MAX)
+    { sourceBlock = pickSourceBlock(); }
+
+    if(sourceBlock == UINT32_MAX) return;
+
+    std::vector<uint32_t> candidates;
+    for(size_t i = 0; i < allocator->entries.size(); i++)
+    {
+        const DeviceAllocator::Entry &entry = allocator->entries[i];
+        uint32_t allocation = static_cast<uint32_t>(i);
+
+        if(entry.live && entry.block == sourceBlock && !isPending(allocation))
+        { candidates.push_back(allocation); }
+    }
+
+    VkDeviceSize budget = bytesPerFrame;
+    bool recorded = false;
+
+    for(uint32_t source : candidates)
+    {
+        VkDeviceSize size = allocator->entries[source].size;
+        if(recorded && size > budget) break;
+
+        uint32_t destination;
+        if(!createDestination(source, destination))
+        {
+            //the rest of the block does not fit anywhere else, leave it alone
+            skippedBlocks.push_back(sourceBlock);
+            sourceBlock = UINT32_MAX;
+            break;
+        }
+
+        if(!recorded)
+        {
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        recordCopy(commandBuffer, source, destination);
+        pendingMoves.push_back({source, destination, frameNumber});
+
+        budget = size > budget ? 0 : budget - size;
+        recorded = true;
+    }
+
+    if(recorded)
+    {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    stats.pendingMoves = static_cast<uint32_t>(pendingMoves.size());
+}
+
+void Defragmenter::update(uint64_t completedFrames, uint64_t frameNumber,
+    std::vector<DefragMove> &finishedMoves)
+{
+    VkDevice device = allocator->device;
+    std::vector<DeviceAllocator::Entry> &entries = allocator->entries;
+
+    for(size_t i = 0; i < pendingMoves.size();)
+    {
+        PendingMove move = pendingMoves[i];
+
+        if(move.copyFrame >= completedFrames)
+        {
+            i++;
+            continue;
+        }
+
+        DefragMove finished{};
+        finished.allocation = move.source;
+        finished.oldBuffer = entries[move.source].buffer;
+        finished.newBuffer = entries[move.destination].buffer;
+        finished.oldImage = entries[move.source].image;
+        finished.newImage = entries[move.destination].image;
+        finishedMoves.push_back(finished);
+
+        stats.movedBytes += entries[move.source].size;
+        stats.moveCount++;
+
+        //the caller keeps its id, the old placement is retired under the other one
+        std::swap(entries[move.source], entries[move.destination]);
+
+        //frames up to the previous one were recorded against the old handle
+        RetiredResource resource{};
+        resource.buffer = entries[move.destination].buffer;
+        resource.image = entries[move.destination].image;
+        resource.allocation = move.destination;
+        resource.lastUseFrame = frameNumber - 1;
+        retired.push_back(resource);
+
+        pendingMoves.erase(pendingMoves.begin() + i);
+    }
+
+    bool freed = false;
+    for(size_t i = 0; i < retired.size();)
+    {
+        if(retired[i].lastUseFrame >= completedFrames)
+        {
+            i++;
+            continue;
+        }
+
+        if(retired[i].buffer != VK_NULL_HANDLE)
+        { vkDestroyBuffer(device, retired[i].buffer, nullptr); }
+        if(retired[i].image != VK_NULL_HANDLE)
+        { vkDestroyImage(device, retired[i].image, nullptr); }
+
+        allocator->free(retired[i].allocation);
+        retired.erase(retired.begin() + i);
+        freed = true;
+    }
+
+    if(freed)
+    {
+        stats.releasedBlocks += allocator->releaseEmptyBlocks();
+
+        //free space moved around, blocks that did not fit before may now
+        skippedBlocks.clear();
+    }
+
+    stats.pendingMoves = static_cast<uint32_t>(pendingMoves.size());
+}
+
+void Defragmenter::destroy()
+{
+    VkDevice device = allocator->device;
+    std::vector<DeviceAllocator::Entry> &entries = allocator->entries;
+
+    for(const PendingMove &move : pendingMoves)
+    {
+        if(entries[move.destination].buffer != VK_NULL_HANDLE)
+        { vkDestroyBuffer(device, entries[move.destination].buffer, nullptr); }
+        if(entries[move.destination].image != VK_NULL_HANDLE)
+        { vkDestroyImage(device, entries[move.destination].image, nullptr); }
+
+        allocator->free(move.destination);
+    }
+
+    for(const RetiredResource &resource : retired)
+    {
+        if(resource.buffer != VK_NULL_HANDLE)
+        { vkDestroyBuffer(device, resource.buffer, nullptr); }
+        if(resource.image != VK_NULL_HANDLE)
+        { vkDestroyImage(device, resource.image, nullptr); }
+
+        allocator->free(resource.allocation);
+    }
+
+    pendingMoves.clear();
+    retired.clear();
+}
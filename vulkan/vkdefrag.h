@@ -0,0 +1,84 @@
+#ifndef VK_DEFRAG_H
+#define VK_DEFRAG_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <vkallocator.h>
+#include <vector>
+
+//A resource whose contents now live in a new buffer or image. The owner has to
+//swap its handle and rewrite any descriptors or views pointing at the old one.
+struct DefragMove
+{
+    uint32_t allocation;
+    VkBuffer oldBuffer;
+    VkBuffer newBuffer;
+    VkImage oldImage;
+    VkImage newImage;
+};
+
+struct DefragStats
+{
+    uint64_t movedBytes;
+    uint32_t moveCount;
+    uint32_t releasedBlocks;
+    uint32_t pendingMoves;
+};
+
+//Empties sparsely used blocks a few allocations at a time. Copies are recorded
+//into the frame's command buffer, handles are swapped once that frame has
+//completed, and the old resources are released once no frame can still use them.
+class Defragmenter
+{
+    public:
+        void init(DeviceAllocator *allocator, VkDeviceSize bytesPerFrame, float maxBlockUsage);
+
+        //must be recorded outside a render pass, before anything that reads the moved resources
+        void recordMoves(VkCommandBuffer commandBuffer, uint64_t frameNumber);
+
+        //frame numbers only have to increase, e.g. timeline semaphore values
+        //completedFrames: every frame numbered below this has finished on the GPU
+        void update(uint64_t completedFrames, uint64_t frameNumber, std::vector<DefragMove> &finishedMoves);
+
+        void destroy();
+
+        DefragStats getStats() const
+        { return stats; }
+
+    private:
+        struct PendingMove
+        {
+            uint32_t source;
+            uint32_t destination;
+            uint64_t copyFrame;
+        };
+
+        struct RetiredResource
+        {
+            VkBuffer buffer;
+            VkImage image;
+            uint32_t allocation;
+            uint64_t lastUseFrame;
+        };
+
+        DeviceAllocator *allocator = nullptr;
+        VkDeviceSize bytesPerFrame = 0;
+        float maxBlockUsage = 0.0f;
+
+        uint32_t sourceBlock = UINT32_MAX;
+        std::vector<uint32_t> skippedBlocks;
+        std::vector<PendingMove> pendingMoves;
+        std::vector<RetiredResource> retired;
+
+        DefragStats stats{};
+
+        uint32_t pickSourceBlock();
+
+        bool isPending(uint32_t allocation) const;
+
+        bool createDestination(uint32_t source, uint32_t &destination);
+
+        void recordCopy(VkCommandBuffer commandBuffer, uint32_t source, uint32_t destination);
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include <vkdeletionqueue.h>
+#include <stdexcept>
+
+void DeletionQueue::init(VkDevice &device, DeviceAllocator *allocator)
+{
+    this->device = device;
+    this->allocator = allocator;
+}
+
+void DeletionQueue::push(VkObjectType type, uint64_t handle, uint64_t parent, uint32_t allocation,
+    VkDeviceSize size, uint64_t value)
+{
+    Request request{};
+    request.type = type;
+    request.handle = handle;
+    request.parent = parent;
+    request.allocation = allocation;
+    request.size = size;
+    request.value = value;
+
+    requests.push_back(request);
+
+    stats.pendingHandles++;
+    stats.pendingBytes += size;
+}
+
+void DeletionQueue::destroyBuffer(VkBuffer buffer, uint32_t allocation, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_BUFFER, (uint64_t)buffer, 0, allocation, allocator->getSize(allocation), value);
+}
+
+void DeletionQueue::destroyImage(VkImage image, uint32_t allocation, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_IMAGE, (uint64_t)image, 0, allocation, allocator->getSize(allocation), value);
+}
+
+void DeletionQueue::destroyImage(VkImage image, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_IMAGE, (uint64_t)image, 0, UINT32_MAX, 0, value);
+}
+
+void DeletionQueue::destroyImageView(VkImageView imageView, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)imageView, 0, UINT32_MAX, 0, value);
+}
+
+void DeletionQueue::destroyFramebuffer(VkFramebuffer framebuffer, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_FRAMEBUFFER, (uint64_t)framebuffer, 0, UINT32_MAX, 0, value);
+}
+
+void DeletionQueue::destroySwapchain(VkSwapchainKHR swapChain, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_SWAPCHAIN_KHR, (uint64_t)swapChain, 0, UINT32_MAX, 0, value);
+}
+
+void DeletionQueue::destroySampler(VkSampler sampler, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_SAMPLER, (uint64_t)sampler, 0, UINT32_MAX, 0, value);
+}
+
+void DeletionQueue::destroyPipeline(VkPipeline pipeline, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_PIPELINE, (uint64_t)pipeline, 0, UINT32_MAX, 0, value);
+}
+
+void DeletionQueue::destroyShaderModule(VkShaderModule shaderModule, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)shaderModule, 0, UINT32_MAX, 0, value);
+}
+
+void DeletionQueue::freeDescriptorSet(VkDescriptorPool pool, VkDescriptorSet descriptorSet, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_DESCRIPTOR_SET, (uint64_t)descriptorSet, (uint64_t)pool, UINT32_MAX, 0, value);
+}
+
+void DeletionQueue::freeCommandBuffer(VkCommandPool pool, VkCommandBuffer commandBuffer, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_COMMAND_BUFFER, (uint64_t)commandBuffer, (uint64_t)pool, UINT32_MAX, 0, value);
+}
+
+void DeletionQueue::freeMemory(VkDeviceMemory memory, VkDeviceSize size, uint64_t value)
+{
+    push(VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)memory, 0, UINT32_MAX, size, value);
+}
+
+void DeletionQueue::destroy(const Request &request)
+{
+    switch(request.type)
+    {
+        case VK_OBJECT_TYPE_BUFFER:
+            vkDestroyBuffer(device, (VkBuffer)request.handle, nullptr);
+            break;
+        case VK_OBJECT_TYPE_IMAGE:
+            vkDestroyImage(device, (VkImage)request.handle, nullptr);
+            break;
+        case VK_OBJECT_TYPE_IMAGE_VIEW:
+            vkDestroyImageView(device, (VkImageView)request.handle, nullptr);
+            break;
+        case VK_OBJECT_TYPE_FRAMEBUFFER:
+            vkDestroyFramebuffer(device, (VkFramebuffer)request.handle, nullptr);
+            break;
+        case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+            vkDestroySwapchainKHR(device, (VkSwapchainKHR)request.handle, nullptr);
+            break;
+        case VK_OBJECT_TYPE_SAMPLER:
+            vkDestroySampler(device, (VkSampler)request.handle, nullptr);
+            break;
+        case VK_OBJECT_TYPE_PIPELINE:
+            vkDestroyPipeline(device, (VkPipeline)request.handle, nullptr);
+            break;
+        case VK_OBJECT_TYPE_SHADER_MODULE:
+            vkDestroyShaderModule(device, (VkShaderModule)request.handle, nullptr);
+            break;
+        case VK_OBJECT_TYPE_DESCRIPTOR_SET:
+        {
+            VkDescriptorSet descriptorSet = (VkDescriptorSet)request.handle;
+            vkFreeDescriptorSets(device, (VkDescriptorPool)request.parent, 1, &descriptorSet);
+            break;
+        }
+        case VK_OBJECT_TYPE_COMMAND_BUFFER:
+        {
+            VkCommandBuffer commandBuffer = (VkCommandBuffer)request.handle;
+            vkFreeCommandBuffers(device, (VkCommandPool)request.parent, 1, &commandBuffer);
+            break;
+        }
+        case VK_OBJECT_TYPE_DEVICE_MEMORY:
+            vkFreeMemory(device, (VkDeviceMemory)request.handle, nullptr);
+            break;
+        default:
+            throw std::runtime_error("unsupported type in deletion queue");
+    }
+
+    if(request.allocation != UINT32_MAX)
+    { allocator->free(request.allocation); }
+}
+
+void DeletionQueue::flush(uint64_t completedValue)
+{
+    //compacts in place so requests keep the order they were made in
+    size_t kept = 0;
+    for(size_t i = 0; i < requests.size(); i++)
+    {
+        if(requests[i].value > completedValue)
+        {
+            requests[kept++] = requests[i];
+            continue;
+        }
+
+        destroy(requests[i]);
+
+        stats.pendingHandles--;
+        stats.pendingBytes -= requests[i].size;
+        stats.destroyedHandles++;
+        stats.destroyedBytes += requests[i].size;
+    }
+
+    requests.resize(kept);
+}
+
+void DeletionQueue::flushAll()
+{
+    flush(UINT64_MAX);
+}
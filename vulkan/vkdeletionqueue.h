@@ -0,0 +1,73 @@
+#ifndef VK_DELETION_QUEUE_H
+#define VK_DELETION_QUEUE_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <vkallocator.h>
+#include <vector>
+
+struct DeletionQueueStats
+{
+    uint32_t pendingHandles;
+    VkDeviceSize pendingBytes;
+    uint64_t destroyedHandles;
+    VkDeviceSize destroyedBytes;
+};
+
+//Holds destroy requests until the GPU is past the value they were tagged with.
+//Values are whatever the caller counts submits in, e.g. timeline semaphore values:
+//a request tagged N is carried out by flush once N has completed.
+class DeletionQueue
+{
+    public:
+        void init(VkDevice &device, DeviceAllocator *allocator);
+
+        //buffers and images from the DeviceAllocator hand their allocation in as well
+        void destroyBuffer(VkBuffer buffer, uint32_t allocation, uint64_t value);
+        void destroyImage(VkImage image, uint32_t allocation, uint64_t value);
+
+        void destroyImage(VkImage image, uint64_t value);
+        void destroyImageView(VkImageView imageView, uint64_t value);
+        void destroyFramebuffer(VkFramebuffer framebuffer, uint64_t value);
+        void destroySwapchain(VkSwapchainKHR swapChain, uint64_t value);
+        void destroySampler(VkSampler sampler, uint64_t value);
+        void destroyPipeline(VkPipeline pipeline, uint64_t value);
+        void destroyShaderModule(VkShaderModule shaderModule, uint64_t value);
+        void freeDescriptorSet(VkDescriptorPool pool, VkDescriptorSet descriptorSet, uint64_t value);
+        void freeCommandBuffer(VkCommandPool pool, VkCommandBuffer commandBuffer, uint64_t value);
+        void freeMemory(VkDeviceMemory memory, VkDeviceSize size, uint64_t value);
+
+        //carries out every request tagged at or below completedValue
+        void flush(uint64_t completedValue);
+
+        //only once the device is idle
+        void flushAll();
+
+        DeletionQueueStats getStats() const
+        { return stats; }
+
+    private:
+        struct Request
+        {
+            VkObjectType type;
+            uint64_t handle;
+            //pool the handle came from, for descriptor sets and command buffers
+            uint64_t parent;
+            uint32_t allocation;
+            VkDeviceSize size;
+            uint64_t value;
+        };
+
+        VkDevice device = VK_NULL_HANDLE;
+        DeviceAllocator *allocator = nullptr;
+
+        std::vector<Request> requests;
+        DeletionQueueStats stats{};
+
+        void push(VkObjectType type, uint64_t handle, uint64_t parent, uint32_t allocation,
+            VkDeviceSize size, uint64_t value);
+
+        void destroy(const Request &request);
+};
+
+#endif
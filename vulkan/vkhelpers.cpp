@@ -2,8 +2,8 @@
 #include <vkstructs.h>
 #include <stdexcept>
 
-uint32_t findMemoryType(VkPhysicalDevice &physicalDevice, 
-    uint32_t typeFilter, VkMemoryPropertyFlags properties)
+bool tryFindMemoryType(VkPhysicalDevice &physicalDevice, 
+    uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex)
 {
     VkPhysicalDeviceMemoryProperties memoryProperties;
     vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
@@ -13,10 +13,21 @@ uint32_t findMemoryType(VkPhysicalDevice &physicalDevice,
         if((typeFilter & (1 << i)) && 
         (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
         {
-            return i;
+            typeIndex = i;
+            return true;
         }
     }
 
+    return false;
+}
+
+uint32_t findMemoryType(VkPhysicalDevice &physicalDevice, 
+    uint32_t typeFilter, VkMemoryPropertyFlags properties)
+{
+    uint32_t typeIndex;
+    if(tryFindMemoryType(physicalDevice, typeFilter, properties, typeIndex))
+    { return typeIndex; }
+
     throw std::runtime_error("failed to find suitable memory type");  
 }
 
@@ -70,6 +81,63 @@ void createImage(VkDevice &device, VkPhysicalDevice &physicalDevice,
     vkBindImageMemory(device, image, imageMemory, 0);
 }
 
+void createBuffer(VkDevice &device, DeviceAllocator &allocator, VkDeviceSize size, VkBufferUsageFlags usage, 
+    VkMemoryPropertyFlags properties, VkBuffer &buffer, uint32_t &allocation)
+{
+    //device local buffers may be moved by the defragmenter, which copies them on the GPU
+    if(!(properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+    { usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT; }
+
+    VkBufferCreateInfo bufferInfo{};
+    populateBufferCreateInfo(bufferInfo, size, usage);
+
+    if(vkCreateBuffer(device, &bufferInfo, nullptr, &buffer))
+    { throw std::runtime_error("failed to create buffer"); }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
+
+    allocation = allocator.allocate(memoryRequirements, properties, true);
+    allocator.registerBuffer(allocation, buffer, bufferInfo);
+
+    vkBindBufferMemory(device, buffer, allocator.getMemory(allocation), allocator.getOffset(allocation));
+}
+
+void createImage(VkDevice &device, DeviceAllocator &allocator, 
+    uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling,
+    VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImageAspectFlags aspectFlags,
+    VkImage &image, uint32_t &allocation)
+{
+    if(!(properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+    { usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT; }
+
+    VkImageCreateInfo imageInfo{};
+    populateImageCreateInfo(imageInfo, width, height, format, tiling, usage);
+
+    if(vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+    { throw std::runtime_error("failed to create image"); }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device, image, &memRequirements);
+
+    allocation = allocator.allocate(memRequirements, properties, tiling == VK_IMAGE_TILING_LINEAR);
+    allocator.registerImage(allocation, image, imageInfo, aspectFlags);
+
+    vkBindImageMemory(device, image, allocator.getMemory(allocation), allocator.getOffset(allocation));
+}
+
+void destroyBuffer(VkDevice &device, DeviceAllocator &allocator, VkBuffer buffer, uint32_t allocation)
+{
+    vkDestroyBuffer(device, buffer, nullptr);
+    allocator.free(allocation);
+}
+
+void destroyImage(VkDevice &device, DeviceAllocator &allocator, VkImage image, uint32_t allocation)
+{
+    vkDestroyImage(device, image, nullptr);
+    allocator.free(allocation);
+}
+
 VkImageView createImageView(VkDevice &device, VkImage &image, VkFormat format, 
     VkImageAspectFlags aspectFlags)
 {
@@ -81,4 +149,38 @@ VkImageView createImageView(VkDevice &device, VkImage &image, VkFormat format,
     { throw std::runtime_error("failed to create image view"); }
 
     return imageView;
+}
+
+const char* presentModeName(VkPresentModeKHR presentMode)
+{
+    switch(presentMode)
+    {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR: return "fifo";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "fifo-relaxed";
+        default: return "unknown";
+    }
+}
+
+bool parsePresentMode(const std::string &name, VkPresentModeKHR &presentMode)
+{
+    const VkPresentModeKHR presentModes[] = 
+    {
+        VK_PRESENT_MODE_IMMEDIATE_KHR,
+        VK_PRESENT_MODE_MAILBOX_KHR,
+        VK_PRESENT_MODE_FIFO_KHR,
+        VK_PRESENT_MODE_FIFO_RELAXED_KHR
+    };
+
+    for(VkPresentModeKHR mode : presentModes)
+    {
+        if(name == presentModeName(mode))
+        {
+            presentMode = mode;
+            return true;
+        }
+    }
+
+    return false;
 }
\ No newline at end of file
@@ -3,6 +3,11 @@
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_core.h>
 #define GLFW_INCLUDE_VULKAN
+#include <vkallocator.h>
+#include <string>
+
+bool tryFindMemoryType(VkPhysicalDevice &physicalDevice, 
+    uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex);
 
 uint32_t findMemoryType(VkPhysicalDevice &physicalDevice, 
     uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -16,7 +21,25 @@ void createImage(VkDevice &device, VkPhysicalDevice &physicalDevice,
     VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
     VkImage &image, VkDeviceMemory &imageMemory);
 
+void createBuffer(VkDevice &device, DeviceAllocator &allocator, 
+    VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
+    VkBuffer &buffer, uint32_t &allocation);
+
+void createImage(VkDevice &device, DeviceAllocator &allocator, 
+    uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling,
+    VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImageAspectFlags aspectFlags,
+    VkImage &image, uint32_t &allocation);
+
+void destroyBuffer(VkDevice &device, DeviceAllocator &allocator, VkBuffer buffer, uint32_t allocation);
+
+void destroyImage(VkDevice &device, DeviceAllocator &allocator, VkImage image, uint32_t allocation);
+
 VkImageView createImageView(VkDevice &device, VkImage &image, VkFormat format, 
     VkImageAspectFlags aspectFlags);
 
+const char* presentModeName(VkPresentModeKHR presentMode);
+
+//accepts the names given by presentModeName
+bool parsePresentMode(const std::string &name, VkPresentModeKHR &presentMode);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include <vkpipelinecache.h>
+#include <stdexcept>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <chrono>
+#include <vector>
+#include <string.h>
+
+static const uint32_t CACHE_FILE_MAGIC = 0x48435042;
+static const uint32_t CACHE_FILE_VERSION = 1;
+
+//fnv-1a, only there to catch truncated or damaged files
+static uint64_t checksum(const char *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for(size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+PipelineCache::FileHeader PipelineCache::makeHeader(uint64_t dataSize, uint64_t checksum) const
+{
+    FileHeader header{};
+    header.magic = CACHE_FILE_MAGIC;
+    header.version = CACHE_FILE_VERSION;
+    header.vendorID = properties.vendorID;
+    header.deviceID = properties.deviceID;
+    header.driverVersion = properties.driverVersion;
+    memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = dataSize;
+    header.checksum = checksum;
+
+    return header;
+}
+
+std::string PipelineCache::loadData(std::string &reason)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+    if(!file.is_open())
+    {
+        reason = "no cache file";
+        return std::string();
+    }
+
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    FileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    FileHeader expected = makeHeader(header.dataSize, header.checksum);
+
+    if(!file || header.magic != expected.magic || header.version != expected.version)
+    { reason = "not a cache file"; }
+    else if(header.vendorID != expected.vendorID || header.deviceID != expected.deviceID)
+    { reason = "written by another device"; }
+    else if(header.driverVersion != expected.driverVersion
+        || memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    { reason = "written by another driver"; }
+    else if(fileSize < sizeof(header) || header.dataSize != fileSize - sizeof(header))
+    { reason = "damaged"; }
+
+    if(!reason.empty()) return std::string();
+
+    std::string data(static_cast<size_t>(header.dataSize), '\0');
+    file.read(&data[0], data.size());
+
+    if(!file || checksum(data.data(), data.size()) != header.checksum)
+    {
+        reason = "damaged";
+        return std::string();
+    }
+
+    return data;
+}
+
+void PipelineCache::create(VkDevice &device, VkPhysicalDevice &physicalDevice, const std::string &path)
+{
+    this->device = device;
+    this->path = path;
+
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    std::string reason;
+    std::string data = loadData(reason);
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if(vkCreatePipelineCache(device, &createInfo, nullptr, &cache) != VK_SUCCESS)
+    { throw std::runtime_error("failed to create pipeline cache"); }
+
+    stats.loadedBytes = data.size();
+    lastSavedSize = data.size();
+
+    if(data.empty())
+    { std::cout << "pipeline cache: starting empty, " << reason << std::endl; }
+    else
+    { std::cout << "pipeline cache: loaded " << data.size() / 1024 << " KiB" << std::endl; }
+}
+
+void PipelineCache::destroy()
+{
+    save();
+
+    PipelineCacheStats summary = getStats();
+    std::cout << "pipeline cache: " << summary.hitCount << " hits ("
+        << (summary.hitCount > 0 ? summary.hitMs / summary.hitCount : 0.0) << " ms avg), "
+        << summary.compileCount << " compiles ("
+        << (summary.compileCount > 0 ? summary.compileMs / summary.compileCount : 0.0) << " ms avg)" << std::endl;
+
+    vkDestroyPipelineCache(device, cache, nullptr);
+    cache = VK_NULL_HANDLE;
+}
+
+void PipelineCache::save()
+{
+    size_t size = 0;
+    if(vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS || size == lastSavedSize) return;
+
+    std::vector<char> data(size);
+    if(vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS) return;
+    data.resize(size);
+
+    FileHeader header = makeHeader(size, checksum(data.data(), size));
+
+    //a crash mid-write leaves the old file in place instead of half a new one
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), data.size());
+
+        if(!file)
+        {
+            std::cout << "pipeline cache: failed to write " << temporaryPath << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+
+    if(error)
+    {
+        std::cout << "pipeline cache: failed to replace " << path << ", " << error.message() << std::endl;
+        return;
+    }
+
+    lastSavedSize = size;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.savedBytes = size;
+}
+
+VkResult PipelineCache::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo, VkPipeline &pipeline)
+{
+    VkPipelineCreationFeedback pipelineFeedback{};
+    std::vector<VkPipelineCreationFeedback> stageFeedbacks(createInfo.stageCount);
+
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo{};
+    feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+    feedbackInfo.pNext = createInfo.pNext;
+    feedbackInfo.pPipelineCreationFeedback = &pipelineFeedback;
+    feedbackInfo.pipelineStageCreationFeedbackCount = createInfo.stageCount;
+    feedbackInfo.pPipelineStageCreationFeedbacks = stageFeedbacks.data();
+
+    VkGraphicsPipelineCreateInfo info = createInfo;
+    info.pNext = &feedbackInfo;
+
+    auto start = std::chrono::steady_clock::now();
+    VkResult result = vkCreateGraphicsPipelines(device, cache, 1, &info, nullptr, &pipeline);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if(result != VK_SUCCESS) return result;
+
+    bool hit = (pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)
+        && (pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT);
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+
+    if(hit)
+    {
+        stats.hitCount++;
+        stats.hitMs += ms;
+    }
+    else
+    {
+        stats.compileCount++;
+        stats.compileMs += ms;
+    }
+
+    return result;
+}
+
+PipelineCacheStats PipelineCache::getStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+
+    return stats;
+}
@@ -0,0 +1,70 @@
+#ifndef VK_PIPELINE_CACHE_H
+#define VK_PIPELINE_CACHE_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <string>
+#include <mutex>
+
+struct PipelineCacheStats
+{
+    uint32_t hitCount;
+    double hitMs;
+    uint32_t compileCount;
+    double compileMs;
+    size_t loadedBytes;
+    size_t savedBytes;
+};
+
+//VkPipelineCache seeded from and written back to a file. The file carries its
+//own header naming the device and driver that produced it, data from anything
+//else is ignored rather than handed to the driver.
+class PipelineCache
+{
+    public:
+        void create(VkDevice &device, VkPhysicalDevice &physicalDevice, const std::string &path);
+
+        //saves one last time
+        void destroy();
+
+        //writes through a temporary file and a rename, skipped while the cache has not grown
+        void save();
+
+        VkPipelineCache getCache() const
+        { return cache; }
+
+        //times the creation, creation feedback tells cache hits from cold compiles
+        VkResult createGraphicsPipeline(const VkGraphicsPipelineCreateInfo &createInfo, VkPipeline &pipeline);
+
+        PipelineCacheStats getStats();
+
+    private:
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t vendorID;
+            uint32_t deviceID;
+            uint32_t driverVersion;
+            uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+            uint64_t dataSize;
+            uint64_t checksum;
+        };
+
+        VkDevice device = VK_NULL_HANDLE;
+        VkPipelineCache cache = VK_NULL_HANDLE;
+        VkPhysicalDeviceProperties properties{};
+        std::string path;
+        size_t lastSavedSize = 0;
+
+        //pipelines may be created from several threads
+        std::mutex statsMutex;
+        PipelineCacheStats stats{};
+
+        FileHeader makeHeader(uint64_t dataSize, uint64_t checksum) const;
+
+        //empty when the file is missing, damaged or from another device or driver
+        std::string loadData(std::string &reason);
+};
+
+#endif
@@ -0,0 +1,753 @@
+#include <vkpipelinecompiler.h>
+#include <vkstructs.h>
+#include <vkvertex.h>
+#include <shaders/shaderlayout.h>
+#include <heapcounter.h>
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+
+//the order they are linked in, getLibraries fills its array the same way
+static const std::array<VkGraphicsPipelineLibraryFlagsEXT, 4> LIBRARY_PARTS =
+{
+    VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+};
+
+GraphicsPipelineDesc getDefaultPipelineDesc(VkShaderModule vertShader, VkShaderModule fragShader,
+    VkPipelineLayout layout, VkFormat colorFormat, VkFormat depthFormat)
+{
+    GraphicsPipelineDesc desc{};
+    desc.vertShader = vertShader;
+    desc.fragShader = fragShader;
+    desc.layout = layout;
+    desc.colorFormat = colorFormat;
+    desc.depthFormat = depthFormat;
+    desc.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    desc.cullMode = VK_CULL_MODE_BACK_BIT;
+    desc.depthTest = true;
+    desc.blend = false;
+    desc.features = PIPELINE_TEXTURED;
+
+    return desc;
+}
+
+//fnv-1a over the fields one at a time, the struct has padding
+uint64_t PipelineCompiler::hashDesc(const GraphicsPipelineDesc &desc)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](uint64_t value)
+    {
+        for(int i = 0; i < 8; i++)
+        {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    mix((uint64_t) desc.vertShader);
+    mix((uint64_t) desc.fragShader);
+    mix((uint64_t) desc.layout);
+    mix(desc.colorFormat);
+    mix(desc.depthFormat);
+    mix(desc.topology);
+    mix(desc.cullMode);
+    mix(desc.depthTest);
+    mix(desc.blend);
+    mix(desc.features);
+
+    return hash;
+}
+
+//field by field for the same reason
+bool PipelineCompiler::equalDesc(const GraphicsPipelineDesc &a, const GraphicsPipelineDesc &b)
+{
+    return a.vertShader == b.vertShader && a.fragShader == b.fragShader && a.layout == b.layout
+        && a.colorFormat == b.colorFormat && a.depthFormat == b.depthFormat && a.topology == b.topology
+        && a.cullMode == b.cullMode && a.depthTest == b.depthTest && a.blend == b.blend && a.features == b.features;
+}
+
+//shader modules change with every hot reload, the state they are drawn with does not
+uint64_t PipelineCompiler::hashState(const GraphicsPipelineDesc &desc)
+{
+    GraphicsPipelineDesc state = desc;
+    state.vertShader = VK_NULL_HANDLE;
+    state.fragShader = VK_NULL_HANDLE;
+
+    return hashDesc(state);
+}
+
+//only the fields the part is built from, so combinations that agree on them share it
+PipelineCompiler::LibraryKey PipelineCompiler::getLibraryKey(const GraphicsPipelineDesc &desc,
+    VkGraphicsPipelineLibraryFlagsEXT part)
+{
+    GraphicsPipelineDesc partDesc{};
+
+    switch(part)
+    {
+        case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+            partDesc.topology = desc.topology;
+            break;
+        case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+            partDesc.vertShader = desc.vertShader;
+            partDesc.layout = desc.layout;
+            partDesc.cullMode = desc.cullMode;
+            partDesc.features = desc.features;
+            break;
+        case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+            partDesc.fragShader = desc.fragShader;
+            partDesc.layout = desc.layout;
+            partDesc.colorFormat = desc.colorFormat;
+            partDesc.depthFormat = desc.depthFormat;
+            partDesc.depthTest = desc.depthTest;
+            partDesc.blend = desc.blend;
+            partDesc.features = desc.features;
+            break;
+        case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+            partDesc.colorFormat = desc.colorFormat;
+            partDesc.depthFormat = desc.depthFormat;
+            partDesc.blend = desc.blend;
+            break;
+    }
+
+    return {part, partDesc};
+}
+
+GraphicsPipelineDesc PipelineCompiler::getPipelineDesc(const GraphicsPipelineDesc &desc) const
+{
+    GraphicsPipelineDesc pipelineDesc = desc;
+
+    if(dynamicState & PIPELINE_DYNAMIC_RASTER)
+    {
+        pipelineDesc.cullMode = VK_CULL_MODE_NONE;
+        pipelineDesc.depthTest = true;
+
+        //dynamic topology still has to stay within the class the pipeline was built with
+        if(desc.topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP || desc.topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN)
+        { pipelineDesc.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; }
+    }
+
+    if(dynamicState & PIPELINE_DYNAMIC_BLEND) pipelineDesc.blend = false;
+
+    return pipelineDesc;
+}
+
+void PipelineCompiler::create(VkDevice &device, PipelineCache &cache, uint32_t threadCount, uint32_t dynamicState,
+    bool useLibraries)
+{
+    this->device = device;
+    this->cache = &cache;
+    this->useLibraries = useLibraries;
+
+    //depth write follows blend, which a static blend would bake into the pipeline
+    if(!(dynamicState & PIPELINE_DYNAMIC_RASTER)) dynamicState &= ~PIPELINE_DYNAMIC_BLEND;
+    this->dynamicState = dynamicState;
+
+    if(dynamicState & PIPELINE_DYNAMIC_BLEND)
+    {
+        setColorBlendEnable = (PFN_vkCmdSetColorBlendEnableEXT) vkGetDeviceProcAddr(device, "vkCmdSetColorBlendEnableEXT");
+        setColorBlendEquation = (PFN_vkCmdSetColorBlendEquationEXT) vkGetDeviceProcAddr(device, "vkCmdSetColorBlendEquationEXT");
+
+        if(setColorBlendEnable == nullptr || setColorBlendEquation == nullptr)
+        { throw std::runtime_error("failed to load extended dynamic state 3 commands"); }
+    }
+
+    stopping = false;
+    workers.resize(std::max(threadCount, 1u));
+    for(std::thread &worker : workers)
+    { worker = std::thread(&PipelineCompiler::workerLoop, this); }
+}
+
+void PipelineCompiler::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    workAvailable.notify_all();
+
+    for(std::thread &worker : workers)
+    { worker.join(); }
+    workers.clear();
+
+    //compiles that finished after the last poll still own a pipeline
+    for(const Result &result : finished)
+    {
+        if(result.pipeline != VK_NULL_HANDLE)
+        { vkDestroyPipeline(device, result.pipeline, nullptr); }
+    }
+    finished.clear();
+
+    for(Entry &entry : entries)
+    {
+        if(entry.pipeline != VK_NULL_HANDLE)
+        { vkDestroyPipeline(device, entry.pipeline, nullptr); }
+    }
+    entries.clear();
+    variants.clear();
+    requestedStates.clear();
+
+    //linked pipelines do not need their libraries to stay around
+    for(auto &library : libraries)
+    { vkDestroyPipeline(device, library.second.pipeline, nullptr); }
+    libraries.clear();
+
+    for(VkShaderModule shaderModule : retiredModules)
+    { vkDestroyShaderModule(device, shaderModule, nullptr); }
+    retiredModules.clear();
+}
+
+VkResult PipelineCompiler::build(const GraphicsPipelineDesc &desc, VkGraphicsPipelineLibraryFlagsEXT parts,
+    VkPipeline &pipeline)
+{
+    VkShaderModule vertShader = desc.vertShader;
+    VkShaderModule fragShader = desc.fragShader;
+
+    //a stage ignores the entries for constants it does not declare
+    std::array<VkBool32, 3> specializationData =
+    {
+        (desc.features & PIPELINE_ALPHA_TEST) ? VK_TRUE : VK_FALSE,
+        (desc.features & PIPELINE_TEXTURED) ? VK_TRUE : VK_FALSE,
+        (desc.features & PIPELINE_VERTEX_COLOR) ? VK_TRUE : VK_FALSE
+    };
+
+    std::array<VkSpecializationMapEntry, 3> specializationEntries =
+    {{
+        {SHADER_SPEC_ALPHA_TEST, 0 * sizeof(VkBool32), sizeof(VkBool32)},
+        {SHADER_SPEC_TEXTURED, 1 * sizeof(VkBool32), sizeof(VkBool32)},
+        {SHADER_SPEC_VERTEX_COLOR, 2 * sizeof(VkBool32), sizeof(VkBool32)}
+    }};
+
+    VkSpecializationInfo specializationInfo{};
+    populateSpecializationInfo(specializationInfo, static_cast<uint32_t>(specializationEntries.size()),
+        specializationEntries.data(), sizeof(specializationData), specializationData.data());
+
+    VkPipelineShaderStageCreateInfo shaderStages[2]{};
+    populateVertShaderStageCreateInfo(shaderStages[0], vertShader);
+    populateFragShaderStageCreateInfo(shaderStages[1], fragShader);
+    shaderStages[0].pSpecializationInfo = &specializationInfo;
+    shaderStages[1].pSpecializationInfo = &specializationInfo;
+
+    std::vector<VkDynamicState> dynamicStates =
+    {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    if(dynamicState & PIPELINE_DYNAMIC_RASTER)
+    {
+        dynamicStates.insert(dynamicStates.end(),
+        {
+            VK_DYNAMIC_STATE_CULL_MODE,
+            VK_DYNAMIC_STATE_FRONT_FACE,
+            VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY,
+            VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+            VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+            VK_DYNAMIC_STATE_DEPTH_COMPARE_OP
+        });
+    }
+
+    if(dynamicState & PIPELINE_DYNAMIC_BLEND)
+    {
+        dynamicStates.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+        dynamicStates.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT);
+    }
+
+    //a library ignores the states that belong to other parts
+    VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
+    populatePipelineDynamicStateCreateInfo(dynamicStateInfo, dynamicStates);
+
+    auto bindingDescription = Vertex::getBindingDescription();
+    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    populatePipelineVertexInputStateCreateInfo(vertexInputInfo, bindingDescription, attributeDescriptions);
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    populatePipelineInputAssemblyStateCreateInfo(inputAssembly);
+    inputAssembly.topology = desc.topology;
+
+    //viewport and scissor are dynamic, only the counts are read
+    VkViewport viewport{};
+    VkRect2D scissor{};
+    VkPipelineViewportStateCreateInfo viewportState{};
+    populatePipelineViewportStateCreateInfo(viewportState, viewport, scissor);
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    populatePipelineRasterizationStateCreateInfo(rasterizer);
+    rasterizer.cullMode = desc.cullMode;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    populatePipelineMultisampleStateCreateInfo(multisampling);
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    populatePipelineColorBlendAttachmentState(colorBlendAttachment);
+    if(desc.blend)
+    {
+        colorBlendAttachment.blendEnable = VK_TRUE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    }
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    populatePipelineColorBlendStateCreateInfo(colorBlending, colorBlendAttachment);
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    populatePipelineDepthStencilStateCreateInfo(depthStencil);
+    depthStencil.depthTestEnable = desc.depthTest ? VK_TRUE : VK_FALSE;
+    depthStencil.depthWriteEnable = desc.depthTest && !desc.blend ? VK_TRUE : VK_FALSE;
+
+    VkPipelineRenderingCreateInfo renderingCreateInfo{};
+    populatePipelineRenderingCreateInfo(renderingCreateInfo, desc.colorFormat, desc.depthFormat);
+
+    bool full = parts == 0;
+    bool vertexInput = full || (parts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+    bool preRasterization = full || (parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+    bool fragmentShader = full || (parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+    bool fragmentOutput = full || (parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+
+    std::vector<VkPipelineShaderStageCreateInfo> stages;
+    if(preRasterization) stages.push_back(shaderStages[0]);
+    if(fragmentShader) stages.push_back(shaderStages[1]);
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+    populateGraphicsPipelineLibraryCreateInfo(libraryInfo, parts, &renderingCreateInfo);
+
+    //a library only gets the state of the parts it holds
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = full ? static_cast<const void*>(&renderingCreateInfo) : &libraryInfo;
+    //kept so the optimized link can still optimize across the parts
+    if(!full) pipelineInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    pipelineInfo.stageCount = static_cast<uint32_t>(stages.size());
+    pipelineInfo.pStages = stages.data();
+    pipelineInfo.pVertexInputState = vertexInput ? &vertexInputInfo : nullptr;
+    pipelineInfo.pInputAssemblyState = vertexInput ? &inputAssembly : nullptr;
+    pipelineInfo.pViewportState = preRasterization ? &viewportState : nullptr;
+    pipelineInfo.pRasterizationState = preRasterization ? &rasterizer : nullptr;
+    pipelineInfo.pMultisampleState = fragmentShader || fragmentOutput ? &multisampling : nullptr;
+    pipelineInfo.pDepthStencilState = fragmentShader ? &depthStencil : nullptr;
+    pipelineInfo.pColorBlendState = fragmentOutput ? &colorBlending : nullptr;
+    pipelineInfo.pDynamicState = &dynamicStateInfo;
+    pipelineInfo.layout = preRasterization || fragmentShader ? desc.layout : VK_NULL_HANDLE;
+    pipelineInfo.renderPass = VK_NULL_HANDLE;
+    pipelineInfo.subpass = 0;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    return cache->createGraphicsPipeline(pipelineInfo, pipeline);
+}
+
+VkResult PipelineCompiler::getLibraries(const GraphicsPipelineDesc &desc, bool onlyExisting,
+    std::array<VkPipeline, 4> &parts)
+{
+    for(size_t i = 0; i < LIBRARY_PARTS.size(); i++)
+    {
+        LibraryKey key = getLibraryKey(desc, LIBRARY_PARTS[i]);
+
+        {
+            std::lock_guard<std::mutex> lock(libraryMutex);
+
+            auto found = libraries.find(key);
+            if(found != libraries.end())
+            {
+                parts[i] = found->second.pipeline;
+                continue;
+            }
+        }
+
+        if(onlyExisting) return VK_INCOMPLETE;
+
+        //built outside the lock, another worker may get there first
+        VkPipeline library = VK_NULL_HANDLE;
+        VkResult result = build(desc, LIBRARY_PARTS[i], library);
+        if(result != VK_SUCCESS) return result;
+
+        VkShaderModule shader = VK_NULL_HANDLE;
+        if(LIBRARY_PARTS[i] == VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) shader = desc.vertShader;
+        if(LIBRARY_PARTS[i] == VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT) shader = desc.fragShader;
+
+        std::lock_guard<std::mutex> lock(libraryMutex);
+
+        auto inserted = libraries.emplace(key, Library{library, shader});
+        if(!inserted.second) vkDestroyPipeline(device, library, nullptr);
+        parts[i] = inserted.first->second.pipeline;
+    }
+
+    return VK_SUCCESS;
+}
+
+VkResult PipelineCompiler::link(const std::array<VkPipeline, 4> &parts, VkPipelineLayout layout, bool optimize,
+    VkPipeline &pipeline)
+{
+    VkPipelineLibraryCreateInfoKHR libraryInfo{};
+    populatePipelineLibraryCreateInfo(libraryInfo, static_cast<uint32_t>(parts.size()), parts.data());
+
+    //all the state comes from the libraries
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = &libraryInfo;
+    pipelineInfo.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    pipelineInfo.layout = layout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    return cache->createGraphicsPipeline(pipelineInfo, pipeline);
+}
+
+VkResult PipelineCompiler::createPipeline(const GraphicsPipelineDesc &desc, bool optimize, VkPipeline &pipeline)
+{
+    if(!useLibraries) return build(desc, 0, pipeline);
+
+    std::array<VkPipeline, 4> parts{};
+    VkResult result = getLibraries(desc, false, parts);
+    if(result != VK_SUCCESS) return result;
+
+    return link(parts, desc.layout, optimize, pipeline);
+}
+
+void PipelineCompiler::recordLatency(Clock::time_point requestTime, Clock::time_point finishTime)
+{
+    lastLatency = std::chrono::duration<double, std::milli>(finishTime - requestTime).count();
+
+    latencies[nextLatency] = lastLatency;
+    nextLatency = (nextLatency + 1) % WINDOW_SIZE;
+    if(latencyCount < WINDOW_SIZE)
+    { latencyCount++; }
+}
+
+uint32_t PipelineCompiler::compile(const GraphicsPipelineDesc &desc)
+{
+    GraphicsPipelineDesc pipelineDesc = getPipelineDesc(desc);
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if(createPipeline(pipelineDesc, false, pipeline) != VK_SUCCESS)
+    { throw std::runtime_error("failed to create graphics pipeline"); }
+
+    entries.push_back({pipelineDesc, pipeline, NO_PIPELINE, false, 0});
+
+    uint32_t handle = static_cast<uint32_t>(entries.size() - 1);
+    variants.emplace(pipelineDesc, handle);
+    requestedStates.insert(hashState(desc));
+
+    //a fast link, the optimized one replaces it in the background
+    if(useLibraries)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fastLinkCount++;
+            jobs.push_back({handle, 0, pipelineDesc, Clock::now(), true});
+        }
+        workAvailable.notify_one();
+    }
+
+    return handle;
+}
+
+uint32_t PipelineCompiler::request(const GraphicsPipelineDesc &desc, uint32_t fallback)
+{
+    GraphicsPipelineDesc pipelineDesc = getPipelineDesc(desc);
+    Clock::time_point requestTime = Clock::now();
+
+    uint32_t handle = static_cast<uint32_t>(entries.size());
+    entries.push_back({pipelineDesc, VK_NULL_HANDLE, fallback, false, 0});
+
+    //with every part built already a fast link is cheap enough to do right here
+    std::array<VkPipeline, 4> parts{};
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    bool linked = useLibraries && getLibraries(pipelineDesc, true, parts) == VK_SUCCESS
+        && link(parts, pipelineDesc.layout, false, pipeline) == VK_SUCCESS;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        //handed over through poll like any other result
+        if(linked)
+        {
+            finished.push_back({handle, 0, pipeline, VK_SUCCESS});
+            fastLinkCount++;
+            recordLatency(requestTime, Clock::now());
+        }
+
+        jobs.push_back({handle, 0, pipelineDesc, requestTime, linked});
+    }
+    workAvailable.notify_one();
+
+    return handle;
+}
+
+uint32_t PipelineCompiler::getVariant(const GraphicsPipelineDesc &desc, uint32_t fallback)
+{
+    requestedStates.insert(hashState(desc));
+
+    GraphicsPipelineDesc pipelineDesc = getPipelineDesc(desc);
+
+    auto found = variants.find(pipelineDesc);
+    if(found != variants.end()) return found->second;
+
+    uint32_t handle = request(desc, fallback);
+    variants.emplace(pipelineDesc, handle);
+
+    return handle;
+}
+
+void PipelineCompiler::recordDynamicState(VkCommandBuffer commandBuffer, const GraphicsPipelineDesc &desc) const
+{
+    if(dynamicState & PIPELINE_DYNAMIC_RASTER)
+    {
+        //front face and compare op match the static defaults in vkstructs
+        vkCmdSetCullMode(commandBuffer, desc.cullMode);
+        vkCmdSetFrontFace(commandBuffer, VK_FRONT_FACE_COUNTER_CLOCKWISE);
+        vkCmdSetPrimitiveTopology(commandBuffer, desc.topology);
+        vkCmdSetDepthTestEnable(commandBuffer, desc.depthTest ? VK_TRUE : VK_FALSE);
+        vkCmdSetDepthWriteEnable(commandBuffer, desc.depthTest && !desc.blend ? VK_TRUE : VK_FALSE);
+        vkCmdSetDepthCompareOp(commandBuffer, VK_COMPARE_OP_LESS);
+    }
+
+    if(dynamicState & PIPELINE_DYNAMIC_BLEND)
+    {
+        VkBool32 blendEnable = desc.blend ? VK_TRUE : VK_FALSE;
+        setColorBlendEnable(commandBuffer, 0, 1, &blendEnable);
+
+        //ignored while blending is off
+        VkColorBlendEquationEXT equation{};
+        equation.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        equation.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        equation.colorBlendOp = VK_BLEND_OP_ADD;
+        equation.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        equation.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        equation.alphaBlendOp = VK_BLEND_OP_ADD;
+        setColorBlendEquation(commandBuffer, 0, 1, &equation);
+    }
+}
+
+uint32_t PipelineCompiler::replaceShader(VkShaderModule oldModule, VkShaderModule newModule)
+{
+    uint32_t rebuilt = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        //queued requests are rewritten rather than compiled twice
+        for(Job &job : jobs)
+        {
+            if(job.desc.vertShader == oldModule) job.desc.vertShader = newModule;
+            if(job.desc.fragShader == oldModule) job.desc.fragShader = newModule;
+        }
+
+        Clock::time_point now = Clock::now();
+        for(uint32_t i = 0; i < entries.size(); i++)
+        {
+            Entry &entry = entries[i];
+            if(entry.desc.vertShader != oldModule && entry.desc.fragShader != oldModule) continue;
+
+            GraphicsPipelineDesc oldDesc = entry.desc;
+
+            if(entry.desc.vertShader == oldModule) entry.desc.vertShader = newModule;
+            if(entry.desc.fragShader == oldModule) entry.desc.fragShader = newModule;
+            entry.generation++;
+
+            //still found by the desc that now names the new module
+            auto variant = variants.find(oldDesc);
+            if(variant != variants.end() && variant->second == i)
+            {
+                variants.erase(variant);
+                variants.emplace(entry.desc, i);
+            }
+
+            //an optimized link still waiting would need the old parts, it starts over from a fast link
+            bool queued = false;
+            for(Job &job : jobs)
+            {
+                if(job.handle != i) continue;
+
+                job.generation = entry.generation;
+                job.optimize = false;
+                queued = true;
+            }
+
+            if(!queued) jobs.push_back({i, entry.generation, entry.desc, now, false});
+            rebuilt++;
+        }
+
+        retiredModules.push_back(oldModule);
+    }
+    workAvailable.notify_all();
+
+    return rebuilt;
+}
+
+bool PipelineCompiler::poll(DeletionQueue &deletionQueue, uint64_t retireValue)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        //compiles picked up after the replace only see the new modules
+        if(compiling == 0 && !retiredModules.empty())
+        {
+            //nothing is linking either, linked pipelines keep working without their libraries
+            std::lock_guard<std::mutex> libraryLock(libraryMutex);
+            for(auto library = libraries.begin(); library != libraries.end();)
+            {
+                bool retired = std::find(retiredModules.begin(), retiredModules.end(),
+                    library->second.shader) != retiredModules.end();
+
+                if(retired)
+                {
+                    vkDestroyPipeline(device, library->second.pipeline, nullptr);
+                    library = libraries.erase(library);
+                }
+                else
+                { library++; }
+            }
+
+            for(VkShaderModule shaderModule : retiredModules)
+            { vkDestroyShaderModule(device, shaderModule, nullptr); }
+            retiredModules.clear();
+        }
+
+        if(finished.empty()) return false;
+
+        //swapped rather than copied, both keep their capacity
+        collected.swap(finished);
+    }
+
+    bool changed = false;
+    for(const Result &result : collected)
+    {
+        Entry &entry = entries[result.handle];
+
+        //built from a shader that has been replaced since, never bound
+        if(result.generation != entry.generation)
+        {
+            if(result.pipeline != VK_NULL_HANDLE)
+            { vkDestroyPipeline(device, result.pipeline, nullptr); }
+        }
+        else if(result.result != VK_SUCCESS)
+        {
+            //keeps drawing with the pipeline it had, or its fallback
+            entry.failed = true;
+            std::cout << "pipeline compiler: pipeline " << result.handle << " failed to compile ("
+                << result.result << ")" << std::endl;
+        }
+        else
+        {
+            //frames up to retireValue may still be drawing with it
+            if(entry.pipeline != VK_NULL_HANDLE)
+            { deletionQueue.destroyPipeline(entry.pipeline, retireValue); }
+
+            entry.pipeline = result.pipeline;
+            entry.failed = false;
+            changed = true;
+        }
+    }
+
+    collected.clear();
+
+    return changed;
+}
+
+VkPipeline PipelineCompiler::resolve(uint32_t handle) const
+{
+    while(handle != NO_PIPELINE)
+    {
+        const Entry &entry = entries[handle];
+        if(entry.pipeline != VK_NULL_HANDLE) return entry.pipeline;
+
+        handle = entry.fallback;
+    }
+
+    return VK_NULL_HANDLE;
+}
+
+PipelineCompilerStats PipelineCompiler::getStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    PipelineCompilerStats stats{};
+    stats.queueDepth = static_cast<uint32_t>(jobs.size());
+    stats.compiling = compiling;
+    stats.compiledCount = compiledCount;
+    stats.fastLinkCount = fastLinkCount;
+    stats.failedCount = failedCount;
+    stats.variantCount = static_cast<uint32_t>(variants.size());
+    stats.stateCount = static_cast<uint32_t>(requestedStates.size());
+
+    {
+        std::lock_guard<std::mutex> libraryLock(libraryMutex);
+        stats.libraryCount = static_cast<uint32_t>(libraries.size());
+    }
+    stats.lastLatencyMs = lastLatency;
+
+    if(latencyCount == 0) return stats;
+
+    double sum = 0.0;
+    for(size_t i = 0; i < latencyCount; i++)
+    {
+        sum += latencies[i];
+        stats.maxLatencyMs = std::max(stats.maxLatencyMs, latencies[i]);
+    }
+
+    stats.meanLatencyMs = sum / latencyCount;
+
+    return stats;
+}
+
+void PipelineCompiler::workerLoop()
+{
+    //compiles are not part of any frame
+    ignoreHeapAllocations();
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true)
+    {
+        workAvailable.wait(lock, [&]{ return stopping || !jobs.empty(); });
+
+        if(stopping) return;
+
+        //optimized links only speed up pipelines that can already be drawn with, they go last
+        auto next = std::find_if(jobs.begin(), jobs.end(), [](const Job &job){ return !job.optimize; });
+        if(next == jobs.end()) next = jobs.begin();
+
+        Job job = *next;
+        jobs.erase(next);
+        compiling++;
+
+        lock.unlock();
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = createPipeline(job.desc, job.optimize, pipeline);
+        Clock::time_point finishTime = Clock::now();
+        lock.lock();
+
+        compiling--;
+        finished.push_back({job.handle, job.generation, pipeline, result});
+
+        if(result != VK_SUCCESS)
+        {
+            failedCount++;
+            continue;
+        }
+
+        if(job.optimize)
+        {
+            compiledCount++;
+            continue;
+        }
+
+        recordLatency(job.requestTime, finishTime);
+
+        if(!useLibraries)
+        {
+            compiledCount++;
+            continue;
+        }
+
+        //drawn with the fast link until this replaces it
+        fastLinkCount++;
+        jobs.push_back({job.handle, job.generation, job.desc, finishTime, true});
+        workAvailable.notify_one();
+    }
+}
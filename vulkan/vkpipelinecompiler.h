@@ -0,0 +1,280 @@
+#ifndef VK_PIPELINE_COMPILER_H
+#define VK_PIPELINE_COMPILER_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <vkpipelinecache.h>
+#include <vkdeletionqueue.h>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+//shader features chosen per pipeline with specialization constants, so each
+//variant only contains the code it uses
+enum PipelineFeatureFlags : uint32_t
+{
+    PIPELINE_ALPHA_TEST = 1,
+    PIPELINE_TEXTURED = 2,
+    PIPELINE_VERTEX_COLOR = 4
+};
+
+//state set on the command buffer instead of baked in, descs that only differ
+//in it share one pipeline
+enum PipelineDynamicStateFlags : uint32_t
+{
+    //cull mode, front face, topology and depth test, core since 1.3
+    PIPELINE_DYNAMIC_RASTER = 1,
+    //blend enable and equation, needs VK_EXT_extended_dynamic_state3
+    PIPELINE_DYNAMIC_BLEND = 2
+};
+
+//everything a graphics pipeline is built from, copied into the request so the
+//shader modules and layout only have to outlive the compile
+struct GraphicsPipelineDesc
+{
+    VkShaderModule vertShader;
+    VkShaderModule fragShader;
+    VkPipelineLayout layout;
+    //attachment formats for dynamic rendering, there is no render pass
+    VkFormat colorFormat;
+    VkFormat depthFormat;
+    VkPrimitiveTopology topology;
+    VkCullModeFlags cullMode;
+    bool depthTest;
+    bool blend;
+    uint32_t features;
+};
+
+//the usual opaque textured pipeline, back faces culled and depth tested
+GraphicsPipelineDesc getDefaultPipelineDesc(VkShaderModule vertShader, VkShaderModule fragShader,
+    VkPipelineLayout layout, VkFormat colorFormat, VkFormat depthFormat);
+
+struct PipelineCompilerStats
+{
+    //requests not picked up by a worker yet
+    uint32_t queueDepth;
+    uint32_t compiling;
+    //full compiles and optimized links
+    uint32_t compiledCount;
+    //fast links from pipeline libraries, each later replaced by an optimized link
+    uint32_t fastLinkCount;
+    uint32_t libraryCount;
+    uint32_t failedCount;
+    uint32_t variantCount;
+    //distinct state combinations asked for, variantCount is how many pipelines they took
+    uint32_t stateCount;
+    //request to the first pipeline that can be drawn with, queue wait included
+    double lastLatencyMs;
+    double meanLatencyMs;
+    double maxLatencyMs;
+};
+
+//Builds graphics pipelines on worker threads through the shared PipelineCache.
+//Pipelines are named by handles that can be drawn with straight away: until
+//the compile is done they resolve to their fallback, or to VK_NULL_HANDLE when
+//there is none and the draws should be skipped. Handles and what they resolve
+//to only change in poll, so recording never has to lock.
+//With pipeline libraries the vertex input, pre-rasterization, fragment shader
+//and fragment output parts are each compiled once and shared. A new combination
+//is a fast link of existing parts, replaced later by an optimized link.
+class PipelineCompiler
+{
+    public:
+        static const uint32_t NO_PIPELINE = UINT32_MAX;
+
+        //dynamicState is a mask of PipelineDynamicStateFlags, blend is only dynamic along with raster
+        //useLibraries needs VK_EXT_graphics_pipeline_library enabled on the device
+        void create(VkDevice &device, PipelineCache &cache, uint32_t threadCount, uint32_t dynamicState,
+            bool useLibraries);
+
+        //joins the workers, then destroys every pipeline it built
+        //requests still queued are dropped
+        void destroy();
+
+        //blocks until built, for the pipelines everything else falls back to
+        uint32_t compile(const GraphicsPipelineDesc &desc);
+
+        //queued for the workers, fallback may be NO_PIPELINE
+        uint32_t request(const GraphicsPipelineDesc &desc, uint32_t fallback);
+
+        //the pipeline for desc, requested the first time and the same handle after that
+        uint32_t getVariant(const GraphicsPipelineDesc &desc, uint32_t fallback);
+
+        //builds every pipeline using oldModule again with newModule, they keep drawing
+        //with the old pipeline until the rebuild is done, returns how many were queued
+        //oldModule is destroyed once no compile can still be reading it
+        uint32_t replaceShader(VkShaderModule oldModule, VkShaderModule newModule);
+
+        //collects finished compiles, true when what any handle resolves to has changed
+        //pipelines that were replaced go to the deletion queue tagged with retireValue
+        bool poll(DeletionQueue &deletionQueue, uint64_t retireValue);
+
+        //what draws with this handle bind right now
+        //safe from the recording threads as long as poll is not running
+        VkPipeline resolve(uint32_t handle) const;
+
+        //sets what this compiler left out of desc's pipeline, after binding it or its fallback
+        //safe from the recording threads
+        void recordDynamicState(VkCommandBuffer commandBuffer, const GraphicsPipelineDesc &desc) const;
+
+        uint32_t getDynamicState() const
+        { return dynamicState; }
+
+        bool usesLibraries() const
+        { return useLibraries; }
+
+        bool isReady(uint32_t handle) const
+        { return entries[handle].pipeline != VK_NULL_HANDLE; }
+
+        uint32_t getThreadCount() const
+        { return static_cast<uint32_t>(workers.size()); }
+
+        PipelineCompilerStats getStats();
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        static const size_t WINDOW_SIZE = 64;
+
+        struct Entry
+        {
+            GraphicsPipelineDesc desc;
+            VkPipeline pipeline;
+            uint32_t fallback;
+            bool failed;
+            //bumped by each rebuild, results of older compiles are thrown away
+            uint32_t generation;
+        };
+
+        struct Job
+        {
+            uint32_t handle;
+            uint32_t generation;
+            GraphicsPipelineDesc desc;
+            Clock::time_point requestTime;
+            //links the libraries with link time optimization, the handle already has a fast link
+            bool optimize;
+        };
+
+        struct Result
+        {
+            uint32_t handle;
+            uint32_t generation;
+            VkPipeline pipeline;
+            VkResult result;
+        };
+
+        //descs that hash the same are still told apart by comparing every field
+        struct DescHash
+        {
+            size_t operator()(const GraphicsPipelineDesc &desc) const
+            { return static_cast<size_t>(hashDesc(desc)); }
+        };
+
+        struct DescEqual
+        {
+            bool operator()(const GraphicsPipelineDesc &a, const GraphicsPipelineDesc &b) const
+            { return equalDesc(a, b); }
+        };
+
+        //a library part and the desc fields it is built from, the rest left zero
+        struct LibraryKey
+        {
+            VkGraphicsPipelineLibraryFlagsEXT part;
+            GraphicsPipelineDesc desc;
+        };
+
+        struct LibraryKeyHash
+        {
+            size_t operator()(const LibraryKey &key) const
+            { return static_cast<size_t>(hashDesc(key.desc) * 31 + key.part); }
+        };
+
+        struct LibraryKeyEqual
+        {
+            bool operator()(const LibraryKey &a, const LibraryKey &b) const
+            { return a.part == b.part && equalDesc(a.desc, b.desc); }
+        };
+
+        VkDevice device = VK_NULL_HANDLE;
+        PipelineCache *cache = nullptr;
+        uint32_t dynamicState = 0;
+        bool useLibraries = false;
+        PFN_vkCmdSetColorBlendEnableEXT setColorBlendEnable = nullptr;
+        PFN_vkCmdSetColorBlendEquationEXT setColorBlendEquation = nullptr;
+
+        //only touched by the thread that requests and polls
+        std::vector<Entry> entries;
+        std::vector<Result> collected;
+        //handles by desc, everything compile and getVariant have built
+        std::unordered_map<GraphicsPipelineDesc, uint32_t, DescHash, DescEqual> variants;
+        //hashes of every desc asked for with the shaders left out, for the stats
+        std::unordered_set<uint64_t> requestedStates;
+        //replaced shaders, waiting for the compiles that may read them
+        std::vector<VkShaderModule> retiredModules;
+
+        std::vector<std::thread> workers;
+
+        struct Library
+        {
+            VkPipeline pipeline;
+            //dropped along with it once replaced, a new module may reuse the handle
+            VkShaderModule shader;
+        };
+
+        //library parts by the desc fields each one is built from
+        std::mutex libraryMutex;
+        std::unordered_map<LibraryKey, Library, LibraryKeyHash, LibraryKeyEqual> libraries;
+
+        //guards everything below
+        std::mutex mutex;
+        std::condition_variable workAvailable;
+        bool stopping = false;
+        std::deque<Job> jobs;
+        std::vector<Result> finished;
+        uint32_t compiling = 0;
+        uint32_t compiledCount = 0;
+        uint32_t fastLinkCount = 0;
+        uint32_t failedCount = 0;
+
+        std::array<double, WINDOW_SIZE> latencies{};
+        size_t nextLatency = 0;
+        size_t latencyCount = 0;
+        double lastLatency = 0.0;
+
+        static uint64_t hashDesc(const GraphicsPipelineDesc &desc);
+
+        static bool equalDesc(const GraphicsPipelineDesc &a, const GraphicsPipelineDesc &b);
+
+        static uint64_t hashState(const GraphicsPipelineDesc &desc);
+
+        //desc with the dynamic state reset, what the pipeline is actually built and found by
+        GraphicsPipelineDesc getPipelineDesc(const GraphicsPipelineDesc &desc) const;
+
+        //a full pipeline when parts is 0, otherwise a library holding only those parts
+        VkResult build(const GraphicsPipelineDesc &desc, VkGraphicsPipelineLibraryFlagsEXT parts, VkPipeline &pipeline);
+
+        static LibraryKey getLibraryKey(const GraphicsPipelineDesc &desc, VkGraphicsPipelineLibraryFlagsEXT part);
+
+        //the four parts of desc, built when missing unless onlyExisting
+        VkResult getLibraries(const GraphicsPipelineDesc &desc, bool onlyExisting, std::array<VkPipeline, 4> &parts);
+
+        VkResult link(const std::array<VkPipeline, 4> &parts, VkPipelineLayout layout, bool optimize,
+            VkPipeline &pipeline);
+
+        //links the parts when libraries are used, building the missing ones, otherwise a full build
+        VkResult createPipeline(const GraphicsPipelineDesc &desc, bool optimize, VkPipeline &pipeline);
+
+        //caller holds mutex
+        void recordLatency(Clock::time_point requestTime, Clock::time_point finishTime);
+
+        void workerLoop();
+};
+
+#endif
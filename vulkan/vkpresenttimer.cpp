@@ -0,0 +1,149 @@
+#include <vkpresenttimer.h>
+#include <stdexcept>
+#include <algorithm>
+
+//how long acquire and present can be held up by a wait, in nanoseconds
+static const uint64_t PRESENT_WAIT_TIMEOUT = 500000;
+
+void PresentTimer::create(VkDevice &device, bool enabled)
+{
+    this->device = device;
+    this->enabled = enabled;
+
+    if(!enabled) return;
+
+    waitForPresent = (PFN_vkWaitForPresentKHR) vkGetDeviceProcAddr(device, "vkWaitForPresentKHR");
+    if(waitForPresent == nullptr)
+    { throw std::runtime_error("failed to load vkWaitForPresentKHR"); }
+
+    stopping = false;
+    worker = std::thread(&PresentTimer::workerLoop, this);
+}
+
+void PresentTimer::destroy()
+{
+    if(!worker.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    worker.join();
+
+    pendingCount = 0;
+}
+
+void PresentTimer::track(VkSwapchainKHR swapchain, uint64_t presentId, Clock::time_point sampleTime)
+{
+    if(!enabled) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        //waiting on a later id covers the dropped one anyway
+        if(pendingCount == MAX_PENDING) popPending();
+
+        pending[(pendingHead + pendingCount) % MAX_PENDING] = {swapchain, presentId, sampleTime};
+        pendingCount++;
+    }
+    workAvailable.notify_one();
+}
+
+void PresentTimer::retireSwapchain(VkSwapchainKHR swapchain)
+{
+    if(!enabled) return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    size_t kept = 0;
+    for(size_t i = 0; i < pendingCount; i++)
+    {
+        const PendingPresent &present = pending[(pendingHead + i) % MAX_PENDING];
+        if(present.swapchain != swapchain)
+        { pending[(pendingHead + kept++) % MAX_PENDING] = present; }
+    }
+    pendingCount = kept;
+
+    waitFinished.wait(lock, [&]{ return waitingOn != swapchain; });
+}
+
+void PresentTimer::popPending()
+{
+    pendingHead = (pendingHead + 1) % MAX_PENDING;
+    pendingCount--;
+}
+
+void PresentTimer::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true)
+    {
+        workAvailable.wait(lock, [&]{ return stopping || pendingCount > 0; });
+
+        if(stopping) return;
+
+        PendingPresent present = pending[pendingHead];
+        waitingOn = present.swapchain;
+
+        lock.unlock();
+
+        VkResult result;
+        Clock::time_point presentTime;
+        {
+            std::lock_guard<std::mutex> swapchainLock(swapchainMutex);
+            result = waitForPresent(device, present.swapchain, present.presentId, PRESENT_WAIT_TIMEOUT);
+            presentTime = Clock::now();
+        }
+
+        //lets a blocked acquire or present have the swapchain before the next wait
+        if(result == VK_TIMEOUT) std::this_thread::yield();
+
+        lock.lock();
+
+        waitingOn = VK_NULL_HANDLE;
+        waitFinished.notify_all();
+
+        //still on screen later, try again unless it was retired meanwhile
+        if(result == VK_TIMEOUT) continue;
+
+        const PendingPresent &front = pending[pendingHead];
+        if(pendingCount > 0 && front.swapchain == present.swapchain && front.presentId == present.presentId)
+        { popPending(); }
+
+        //out of date swapchains and lost presents are dropped without a sample
+        if(result != VK_SUCCESS) continue;
+
+        lastLatency = std::chrono::duration<double, std::milli>(presentTime - present.sampleTime).count();
+
+        latencies[nextLatency] = lastLatency;
+        nextLatency = (nextLatency + 1) % WINDOW_SIZE;
+        if(latencyCount < WINDOW_SIZE)
+        { latencyCount++; }
+        presentedFrames++;
+    }
+}
+
+PresentLatencyStats PresentTimer::getStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    PresentLatencyStats stats{};
+    stats.lastMs = lastLatency;
+    stats.presentedFrames = presentedFrames;
+
+    if(latencyCount == 0) return stats;
+
+    double sum = 0.0;
+    for(size_t i = 0; i < latencyCount; i++)
+    {
+        sum += latencies[i];
+        stats.maxMs = std::max(stats.maxMs, latencies[i]);
+    }
+
+    stats.meanMs = sum / latencyCount;
+
+    return stats;
+}
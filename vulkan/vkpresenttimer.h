@@ -0,0 +1,90 @@
+#ifndef VK_PRESENT_TIMER_H
+#define VK_PRESENT_TIMER_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <array>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct PresentLatencyStats
+{
+    double lastMs;
+    double meanMs;
+    double maxMs;
+    uint64_t presentedFrames;
+};
+
+//Measures how long after its camera was sampled a frame actually reached the
+//screen. A worker thread waits in vkWaitForPresentKHR on each tracked present
+//id, so it needs VK_KHR_present_id and VK_KHR_present_wait.
+//The swapchain is externally synchronized in that call, so the worker only waits
+//a fraction of a millisecond at a time while holding the swapchain mutex, and
+//acquire, present and swapchain creation hold it too.
+class PresentTimer
+{
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        //with enabled false nothing is tracked and no thread is started
+        void create(VkDevice &device, bool enabled);
+
+        void destroy();
+
+        bool isEnabled() const
+        { return enabled; }
+
+        //call after the present that carried presentId
+        void track(VkSwapchainKHR swapchain, uint64_t presentId, Clock::time_point sampleTime);
+
+        //drops everything pending on swapchain and returns once the worker no longer waits on it
+        void retireSwapchain(VkSwapchainKHR swapchain);
+
+        PresentLatencyStats getStats();
+
+        //held around every call that takes the swapchain, never while calling retireSwapchain
+        std::mutex &getSwapchainMutex()
+        { return swapchainMutex; }
+
+    private:
+        struct PendingPresent
+        {
+            VkSwapchainKHR swapchain;
+            uint64_t presentId;
+            Clock::time_point sampleTime;
+        };
+
+        //fixed so tracking never allocates, the oldest entry is dropped when full
+        static const size_t MAX_PENDING = 16;
+        static const size_t WINDOW_SIZE = 128;
+
+        VkDevice device = VK_NULL_HANDLE;
+        bool enabled = false;
+        PFN_vkWaitForPresentKHR waitForPresent = nullptr;
+
+        std::array<PendingPresent, MAX_PENDING> pending{};
+        size_t pendingHead = 0;
+        size_t pendingCount = 0;
+        VkSwapchainKHR waitingOn = VK_NULL_HANDLE;
+
+        std::thread worker;
+        std::mutex swapchainMutex;
+        std::mutex mutex;
+        std::condition_variable workAvailable;
+        std::condition_variable waitFinished;
+        bool stopping = false;
+
+        std::array<double, WINDOW_SIZE> latencies{};
+        size_t latencyCount = 0;
+        size_t nextLatency = 0;
+        double lastLatency = 0.0;
+        uint64_t presentedFrames = 0;
+
+        void workerLoop();
+
+        void popPending();
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include <vkrecorder.h>
+#include <stdexcept>
+#include <algorithm>
+
+//slices smaller than this cost more in hand-off than they save
+static const uint32_t MIN_DRAWS_PER_SLICE = 64;
+
+void ParallelRecorder::create(VkDevice &device, uint32_t queueFamilyIndex, 
+    uint32_t threadCount, uint32_t frameCount)
+{
+    this->device = device;
+    this->frameCount = frameCount;
+
+    threadCount = std::max(1u, threadCount);
+    activeThreads = threadCount;
+
+    pools.resize(threadCount * frameCount);
+    buffers.resize(threadCount * frameCount);
+
+    for(size_t i = 0; i < pools.size(); i++)
+    {
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+        if(vkCreateCommandPool(device, &poolInfo, nullptr, &pools[i]) != VK_SUCCESS)
+        { throw std::runtime_error("failed to create recording command pool"); }
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = pools[i];
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+
+        if(vkAllocateCommandBuffers(device, &allocInfo, &buffers[i]) != VK_SUCCESS)
+        { throw std::runtime_error("failed to allocate secondary command buffer"); }
+    }
+
+    stopping = false;
+    for(uint32_t slice = 1; slice < threadCount; slice++)
+    {
+        workers.emplace_back(&ParallelRecorder::workerLoop, this, slice);
+    }
+}
+
+void ParallelRecorder::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for(std::thread &worker : workers)
+    { worker.join(); }
+
+    workers.clear();
+
+    for(VkCommandPool pool : pools)
+    { vkDestroyCommandPool(device, pool, nullptr); }
+
+    pools.clear();
+    buffers.clear();
+}
+
+void ParallelRecorder::setActiveThreadCount(uint32_t count)
+{
+    activeThreads = std::clamp(count, 1u, getThreadCount());
+}
+
+void ParallelRecorder::recordSlice(uint32_t slice)
+{
+    uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(job.drawCount) * slice / job.sliceCount);
+    uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(job.drawCount) * (slice + 1) / job.sliceCount);
+
+    size_t index = slice * frameCount + job.frameIndex;
+
+    vkResetCommandPool(device, pools[index], 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT 
+        | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = job.inheritanceInfo;
+
+    if(vkBeginCommandBuffer(buffers[index], &beginInfo) != VK_SUCCESS)
+    { throw std::runtime_error("failed to begin secondary command buffer"); }
+
+    job.function(buffers[index], first, last - first, job.context);
+
+    if(vkEndCommandBuffer(buffers[index]) != VK_SUCCESS)
+    { throw std::runtime_error("failed to record secondary command buffer"); }
+}
+
+void ParallelRecorder::workerLoop(uint32_t slice)
+{
+    uint64_t seenGeneration = 0;
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]{ return stopping || generation != seenGeneration; });
+
+            if(stopping) return;
+
+            seenGeneration = generation;
+        }
+
+        if(slice < job.sliceCount)
+        {
+            try
+            {
+                recordSlice(slice);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = std::current_exception();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--remaining == 0) done.notify_one();
+        }
+    }
+}
+
+uint32_t ParallelRecorder::record(uint32_t frameIndex, const VkCommandBufferInheritanceInfo &inheritanceInfo,
+    uint32_t drawCount, RecordSliceFunction function, void *context, VkCommandBuffer *secondaryBuffers)
+{
+    uint32_t sliceCount = std::max(1u, std::min(activeThreads, 
+        (drawCount + MIN_DRAWS_PER_SLICE - 1) / MIN_DRAWS_PER_SLICE));
+
+    job.frameIndex = frameIndex;
+    job.inheritanceInfo = &inheritanceInfo;
+    job.drawCount = drawCount;
+    job.sliceCount = sliceCount;
+    job.function = function;
+    job.context = context;
+
+    //a single slice stays on this thread without waking anyone
+    if(sliceCount > 1)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        remaining = static_cast<uint32_t>(workers.size());
+        generation++;
+    }
+
+    if(sliceCount > 1)
+    { wake.notify_all(); }
+
+    std::exception_ptr localError;
+    try
+    {
+        recordSlice(0);
+    }
+    catch(...)
+    {
+        localError = std::current_exception();
+    }
+
+    if(sliceCount > 1)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]{ return remaining == 0; });
+
+        if(!localError && error) localError = error;
+        error = nullptr;
+    }
+
+    if(localError)
+    { std::rethrow_exception(localError); }
+
+    for(uint32_t slice = 0; slice < sliceCount; slice++)
+    {
+        secondaryBuffers[slice] = buffers[slice * frameCount + frameIndex];
+    }
+
+    return sliceCount;
+}
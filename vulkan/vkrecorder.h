@@ -0,0 +1,75 @@
+#ifndef VK_RECORDER_H
+#define VK_RECORDER_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+//records draws [first, first + count) into an already begun secondary command buffer
+typedef void (*RecordSliceFunction)(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count, void *context);
+
+//Splits a draw list across worker threads, each recording its slice into a
+//secondary command buffer. Every thread has its own command pool per frame in
+//flight, so pools are never shared between threads and are reset wholesale.
+//The calling thread records the first slice itself.
+class ParallelRecorder
+{
+    public:
+        void create(VkDevice &device, uint32_t queueFamilyIndex, uint32_t threadCount, uint32_t frameCount);
+
+        void destroy();
+
+        //threads that take part in record, at most the count given to create
+        void setActiveThreadCount(uint32_t count);
+
+        uint32_t getActiveThreadCount() const
+        { return activeThreads; }
+
+        uint32_t getThreadCount() const
+        { return static_cast<uint32_t>(workers.size()) + 1; }
+
+        //the frame slot's previous use must have finished, its pools are reset here
+        //returns how many secondary buffers were written to secondaryBuffers
+        uint32_t record(uint32_t frameIndex, const VkCommandBufferInheritanceInfo &inheritanceInfo,
+            uint32_t drawCount, RecordSliceFunction function, void *context, VkCommandBuffer *secondaryBuffers);
+
+    private:
+        struct Job
+        {
+            uint32_t frameIndex;
+            const VkCommandBufferInheritanceInfo *inheritanceInfo;
+            uint32_t drawCount;
+            uint32_t sliceCount;
+            RecordSliceFunction function;
+            void *context;
+        };
+
+        VkDevice device = VK_NULL_HANDLE;
+        uint32_t frameCount = 0;
+        uint32_t activeThreads = 1;
+
+        //indexed [slice * frameCount + frameIndex]
+        std::vector<VkCommandPool> pools;
+        std::vector<VkCommandBuffer> buffers;
+
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        uint64_t generation = 0;
+        uint32_t remaining = 0;
+        bool stopping = false;
+        std::exception_ptr error;
+
+        Job job{};
+
+        void workerLoop(uint32_t slice);
+
+        void recordSlice(uint32_t slice);
+};
+
+#endif
@@ -0,0 +1,570 @@
+#include <vkrendergraph.h>
+#include <vkstructs.h>
+#include <stdexcept>
+#include <algorithm>
+
+ImageState getImageUsageState(GraphImageUsage usage)
+{
+    switch(usage)
+    {
+        case GRAPH_COLOR_ATTACHMENT:
+            return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        case GRAPH_DEPTH_ATTACHMENT:
+            return {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        case GRAPH_SAMPLED:
+            return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        case GRAPH_STORAGE:
+            return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                VK_IMAGE_LAYOUT_GENERAL};
+        case GRAPH_TRANSFER_SRC:
+            return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+        case GRAPH_TRANSFER_DST:
+            return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+        case GRAPH_PRESENT:
+            return {VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR};
+    }
+
+    throw std::runtime_error("unknown graph image usage");
+}
+
+ImageState getLayoutState(VkImageLayout layout)
+{
+    switch(layout)
+    {
+        case VK_IMAGE_LAYOUT_UNDEFINED:
+            return {VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, layout};
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+            return getImageUsageState(GRAPH_COLOR_ATTACHMENT);
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+            return getImageUsageState(GRAPH_DEPTH_ATTACHMENT);
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+            return getImageUsageState(GRAPH_SAMPLED);
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            return getImageUsageState(GRAPH_TRANSFER_SRC);
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+            return getImageUsageState(GRAPH_TRANSFER_DST);
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+            return getImageUsageState(GRAPH_PRESENT);
+        default:
+            //anything else is treated as touched by everything, correct if not minimal
+            return {VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT, layout};
+    }
+}
+
+static VkImageUsageFlags getUsageFlags(GraphImageUsage usage)
+{
+    switch(usage)
+    {
+        case GRAPH_COLOR_ATTACHMENT: return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        case GRAPH_DEPTH_ATTACHMENT: return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        case GRAPH_SAMPLED: return VK_IMAGE_USAGE_SAMPLED_BIT;
+        case GRAPH_STORAGE: return VK_IMAGE_USAGE_STORAGE_BIT;
+        case GRAPH_TRANSFER_SRC: return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        case GRAPH_TRANSFER_DST: return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        default: return 0;
+    }
+}
+
+static const char* getLayoutName(VkImageLayout layout)
+{
+    switch(layout)
+    {
+        case VK_IMAGE_LAYOUT_UNDEFINED: return "undefined";
+        case VK_IMAGE_LAYOUT_GENERAL: return "general";
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return "color attachment";
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL: return "depth attachment";
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return "shader read";
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return "transfer src";
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return "transfer dst";
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return "present";
+        default: return "other";
+    }
+}
+
+//combined depth stencil formats have to be transitioned with both aspects
+static VkImageAspectFlags getBarrierAspect(VkFormat format, VkImageAspectFlags aspectFlags)
+{
+    if((aspectFlags & VK_IMAGE_ASPECT_DEPTH_BIT) && (format == VK_FORMAT_D32_SFLOAT_S8_UINT
+        || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D16_UNORM_S8_UINT))
+    { return aspectFlags | VK_IMAGE_ASPECT_STENCIL_BIT; }
+
+    return aspectFlags;
+}
+
+void RenderGraph::reset()
+{
+    images.clear();
+    passes.clear();
+    order.clear();
+    barriers.clear();
+    scratchBarriers.clear();
+    firstFinalBarrier = 0;
+    finalBarrierCount = 0;
+    aliasedImages = 0;
+}
+
+uint32_t RenderGraph::importImage(const char *name, VkFormat format, VkImageAspectFlags aspectFlags,
+    const ImageState &initialState, VkImageLayout finalLayout)
+{
+    Image image{};
+    image.name = name;
+    image.imported = true;
+    image.format = format;
+    image.aspectFlags = aspectFlags;
+    image.initialState = initialState;
+    image.finalLayout = finalLayout;
+    image.transientIndex = UINT32_MAX;
+
+    images.push_back(image);
+
+    return static_cast<uint32_t>(images.size() - 1);
+}
+
+uint32_t RenderGraph::createImage(const char *name, uint32_t width, uint32_t height, VkFormat format,
+    VkImageAspectFlags aspectFlags)
+{
+    Image image{};
+    image.name = name;
+    image.imported = false;
+    image.width = width;
+    image.height = height;
+    image.format = format;
+    image.aspectFlags = aspectFlags;
+    image.initialState = getLayoutState(VK_IMAGE_LAYOUT_UNDEFINED);
+    image.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image.transientIndex = UINT32_MAX;
+
+    images.push_back(image);
+
+    return static_cast<uint32_t>(images.size() - 1);
+}
+
+uint32_t RenderGraph::addPass(const char *name, GraphPassFunction function, void *context)
+{
+    Pass pass{};
+    pass.name = name;
+    pass.function = function;
+    pass.context = context;
+
+    passes.push_back(pass);
+
+    return static_cast<uint32_t>(passes.size() - 1);
+}
+
+void RenderGraph::read(uint32_t pass, uint32_t image, GraphImageUsage usage)
+{
+    passes[pass].accesses.push_back({image, usage, false});
+    images[image].usage |= getUsageFlags(usage);
+}
+
+void RenderGraph::write(uint32_t pass, uint32_t image, GraphImageUsage usage)
+{
+    passes[pass].accesses.push_back({image, usage, true});
+    images[image].usage |= getUsageFlags(usage);
+}
+
+void RenderGraph::setSideEffects(uint32_t pass)
+{
+    passes[pass].sideEffects = true;
+}
+
+void RenderGraph::markOutput(uint32_t image)
+{
+    images[image].output = true;
+}
+
+void RenderGraph::cullPasses()
+{
+    std::vector<bool> needed(images.size());
+    for(size_t i = 0; i < images.size(); i++)
+    { needed[i] = images[i].output; }
+
+    for(Pass &pass : passes)
+    { pass.culled = true; }
+
+    //a pass is kept when it writes something needed, which makes everything it reads needed
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+
+        for(Pass &pass : passes)
+        {
+            if(!pass.culled) continue;
+
+            bool keep = pass.sideEffects;
+            for(const Access &access : pass.accesses)
+            {
+                if(access.write && needed[access.image]) keep = true;
+            }
+
+            if(!keep) continue;
+
+            pass.culled = false;
+            changed = true;
+
+            for(const Access &access : pass.accesses)
+            {
+                if(!access.write) needed[access.image] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::sortPasses()
+{
+    //declaration order decides hazards: an earlier pass touching an image a later one
+    //touches has to run first whenever either of them writes it
+    for(size_t b = 0; b < passes.size(); b++)
+    {
+        passes[b].dependencies.clear();
+        if(passes[b].culled) continue;
+
+        for(size_t a = 0; a < b; a++)
+        {
+            if(passes[a].culled) continue;
+
+            bool dependent = false;
+            for(const Access &later : passes[b].accesses)
+            {
+                for(const Access &earlier : passes[a].accesses)
+                {
+                    if(later.image == earlier.image && (later.write || earlier.write)) dependent = true;
+                }
+            }
+
+            if(dependent) passes[b].dependencies.push_back(static_cast<uint32_t>(a));
+        }
+    }
+
+    //kahn's algorithm, lowest declared index first among the ready passes
+    std::vector<uint32_t> remaining(passes.size(), 0);
+    std::vector<bool> done(passes.size(), false);
+    uint32_t keptCount = 0;
+
+    for(size_t i = 0; i < passes.size(); i++)
+    {
+        remaining[i] = static_cast<uint32_t>(passes[i].dependencies.size());
+        if(!passes[i].culled) keptCount++;
+    }
+
+    order.clear();
+    while(order.size() < keptCount)
+    {
+        uint32_t next = UINT32_MAX;
+        for(size_t i = 0; i < passes.size(); i++)
+        {
+            if(!passes[i].culled && !done[i] && remaining[i] == 0)
+            {
+                next = static_cast<uint32_t>(i);
+                break;
+            }
+        }
+
+        if(next == UINT32_MAX)
+        { throw std::runtime_error("render graph has a dependency cycle"); }
+
+        done[next] = true;
+        order.push_back(next);
+
+        for(size_t i = 0; i < passes.size(); i++)
+        {
+            for(uint32_t dependency : passes[i].dependencies)
+            {
+                if(dependency == next) remaining[i]--;
+            }
+        }
+    }
+}
+
+void RenderGraph::allocateTransients(VkDevice &device, VkPhysicalDevice &physicalDevice,
+    TransientImagePool &transientImages)
+{
+    for(Image &image : images)
+    {
+        image.firstUse = UINT32_MAX;
+        image.lastUse = UINT32_MAX;
+    }
+
+    for(size_t position = 0; position < order.size(); position++)
+    {
+        for(const Access &access : passes[order[position]].accesses)
+        {
+            Image &image = images[access.image];
+            if(image.firstUse == UINT32_MAX) image.firstUse = static_cast<uint32_t>(position);
+            image.lastUse = static_cast<uint32_t>(position);
+        }
+    }
+
+    //images with disjoint use ranges may end up sharing memory
+    for(Image &image : images)
+    {
+        if(image.imported || image.firstUse == UINT32_MAX) continue;
+
+        image.transientIndex = transientImages.addImage(image.width, image.height, image.format,
+            image.usage, image.aspectFlags, image.firstUse, image.lastUse);
+    }
+
+    transientImages.allocate(device, physicalDevice);
+
+    for(Image &image : images)
+    {
+        if(image.transientIndex == UINT32_MAX) continue;
+
+        image.image = transientImages.getImage(image.transientIndex);
+        image.view = transientImages.getImageView(image.transientIndex);
+    }
+}
+
+void RenderGraph::computeBarriers(const TransientImagePool &transientImages)
+{
+    std::vector<ImageState> current(images.size());
+    std::vector<bool> lastWasWrite(images.size(), false);
+    //barrier that moved the image into its current read state, widened by further readers
+    std::vector<uint32_t> readBarrier(images.size(), UINT32_MAX);
+    std::vector<uint32_t> firstBarrier(images.size(), UINT32_MAX);
+
+    for(size_t i = 0; i < images.size(); i++)
+    { current[i] = images[i].initialState; }
+
+    barriers.clear();
+
+    for(uint32_t passIndex : order)
+    {
+        Pass &pass = passes[passIndex];
+        pass.firstBarrier = static_cast<uint32_t>(barriers.size());
+
+        for(const Access &access : pass.accesses)
+        {
+            ImageState next = getImageUsageState(access.usage);
+            ImageState &state = current[access.image];
+
+            //a second use of the same image within the pass joins its barrier
+            bool merged = false;
+            for(size_t b = pass.firstBarrier; b < barriers.size(); b++)
+            {
+                if(barriers[b].image != access.image) continue;
+
+                if(barriers[b].to.layout != next.layout)
+                { throw std::runtime_error("image used with two layouts in one pass"); }
+
+                barriers[b].to.stage |= next.stage;
+                barriers[b].to.access |= next.access;
+                merged = true;
+            }
+
+            if(!merged && !access.write && !lastWasWrite[access.image] && state.layout == next.layout)
+            {
+                //read after read in the same layout needs no barrier of its own
+                if(readBarrier[access.image] != UINT32_MAX)
+                {
+                    barriers[readBarrier[access.image]].to.stage |= next.stage;
+                    barriers[readBarrier[access.image]].to.access |= next.access;
+                }
+
+                state.stage |= next.stage;
+                state.access |= next.access;
+                continue;
+            }
+
+            if(!merged)
+            {
+                Barrier barrier{access.image, state, next};
+
+                //write after read only needs the readers to have finished
+                if(!lastWasWrite[access.image]) barrier.from.access = VK_ACCESS_2_NONE;
+
+                if(firstBarrier[access.image] == UINT32_MAX)
+                { firstBarrier[access.image] = static_cast<uint32_t>(barriers.size()); }
+
+                readBarrier[access.image] = access.write ? UINT32_MAX : static_cast<uint32_t>(barriers.size());
+                barriers.push_back(barrier);
+
+                state = next;
+            }
+            else
+            {
+                state.stage |= next.stage;
+                state.access |= next.access;
+
+                if(access.write) readBarrier[access.image] = UINT32_MAX;
+            }
+
+            lastWasWrite[access.image] = merged ? lastWasWrite[access.image] || access.write : access.write;
+        }
+
+        pass.barrierCount = static_cast<uint32_t>(barriers.size()) - pass.firstBarrier;
+    }
+
+    firstFinalBarrier = static_cast<uint32_t>(barriers.size());
+
+    for(size_t i = 0; i < images.size(); i++)
+    {
+        if(!images[i].imported || current[i].layout == images[i].finalLayout) continue;
+
+        Barrier barrier{static_cast<uint32_t>(i), current[i], getLayoutState(images[i].finalLayout)};
+        if(!lastWasWrite[i]) barrier.from.access = VK_ACCESS_2_NONE;
+
+        barriers.push_back(barrier);
+    }
+
+    finalBarrierCount = static_cast<uint32_t>(barriers.size()) - firstFinalBarrier;
+
+    //A transient image starts out as whatever last used its memory: the previous
+    //image in its alias slot, or else itself from the previous frame, since frames
+    //in flight share it. Its first barrier has to wait for that user.
+    aliasedImages = 0;
+    for(size_t i = 0; i < images.size(); i++)
+    {
+        if(images[i].transientIndex == UINT32_MAX || firstBarrier[i] == UINT32_MAX) continue;
+
+        uint32_t slot = transientImages.getSlot(images[i].transientIndex);
+        size_t previous = i;
+
+        if(slot != UINT32_MAX)
+        {
+            uint32_t bestBefore = UINT32_MAX;
+            uint32_t latest = images[i].lastUse;
+
+            for(size_t j = 0; j < images.size(); j++)
+            {
+                if(j == i || images[j].transientIndex == UINT32_MAX
+                    || transientImages.getSlot(images[j].transientIndex) != slot) continue;
+
+                if(images[j].lastUse < images[i].firstUse
+                    && (bestBefore == UINT32_MAX || images[j].lastUse > images[bestBefore].lastUse))
+                { bestBefore = static_cast<uint32_t>(j); }
+
+                if(images[j].lastUse > latest)
+                {
+                    latest = images[j].lastUse;
+                    previous = j;
+                }
+            }
+
+            if(bestBefore != UINT32_MAX)
+            {
+                previous = bestBefore;
+                aliasedImages++;
+            }
+        }
+
+        Barrier &barrier = barriers[firstBarrier[i]];
+        barrier.from.stage = current[previous].stage;
+        barrier.from.access = lastWasWrite[previous] ? current[previous].access : VK_ACCESS_2_NONE;
+        barrier.from.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+}
+
+void RenderGraph::compile(VkDevice &device, VkPhysicalDevice &physicalDevice, TransientImagePool &transientImages)
+{
+    cullPasses();
+    sortPasses();
+    allocateTransients(device, physicalDevice, transientImages);
+    computeBarriers(transientImages);
+
+    size_t largestBatch = finalBarrierCount;
+    for(uint32_t passIndex : order)
+    { largestBatch = std::max(largestBatch, static_cast<size_t>(passes[passIndex].barrierCount)); }
+
+    scratchBarriers.resize(largestBatch);
+}
+
+void RenderGraph::setImportedImage(uint32_t image, VkImage handle, VkImageView view)
+{
+    images[image].image = handle;
+    images[image].view = view;
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)
+{
+    if(count == 0) return;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        const Barrier &barrier = barriers[first + i];
+        const Image &image = images[barrier.image];
+
+        populateImageMemoryBarrier2(scratchBarriers[i], image.image,
+            getBarrierAspect(image.format, image.aspectFlags),
+            barrier.from.stage, barrier.from.access, barrier.from.layout,
+            barrier.to.stage, barrier.to.access, barrier.to.layout);
+    }
+
+    VkDependencyInfo dependencyInfo{};
+    populateDependencyInfo(dependencyInfo, count, scratchBarriers.data());
+
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    for(uint32_t passIndex : order)
+    {
+        const Pass &pass = passes[passIndex];
+
+        recordBarriers(commandBuffer, pass.firstBarrier, pass.barrierCount);
+        pass.function(commandBuffer, pass.context);
+    }
+
+    recordBarriers(commandBuffer, firstFinalBarrier, finalBarrierCount);
+}
+
+void RenderGraph::dump(std::ostream &out) const
+{
+    out << "render graph: " << order.size() << " of " << passes.size() << " passes kept, "
+        << barriers.size() << " barriers, " << aliasedImages << " aliased images" << std::endl;
+
+    for(size_t position = 0; position < order.size(); position++)
+    {
+        const Pass &pass = passes[order[position]];
+
+        out << "  " << position << ": " << pass.name;
+        for(uint32_t dependency : pass.dependencies)
+        { out << (dependency == pass.dependencies.front() ? " after " : ", ") << passes[dependency].name; }
+        out << std::endl;
+
+        for(uint32_t b = pass.firstBarrier; b < pass.firstBarrier + pass.barrierCount; b++)
+        {
+            out << "    barrier " << images[barriers[b].image].name << ": "
+                << getLayoutName(barriers[b].from.layout) << " -> "
+                << getLayoutName(barriers[b].to.layout) << std::endl;
+        }
+    }
+
+    for(uint32_t b = firstFinalBarrier; b < firstFinalBarrier + finalBarrierCount; b++)
+    {
+        out << "  final " << images[barriers[b].image].name << ": "
+            << getLayoutName(barriers[b].from.layout) << " -> "
+            << getLayoutName(barriers[b].to.layout) << std::endl;
+    }
+
+    for(const Pass &pass : passes)
+    {
+        if(pass.culled) out << "  culled " << pass.name << std::endl;
+    }
+
+    for(const Image &image : images)
+    {
+        out << "  image " << image.name;
+
+        if(image.imported) out << " (imported)";
+        else out << " (transient " << image.width << "x" << image.height << ")";
+
+        if(image.firstUse != UINT32_MAX)
+        { out << " used " << image.firstUse << "-" << image.lastUse; }
+        else
+        { out << " unused"; }
+
+        out << std::endl;
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef VK_RENDER_GRAPH_H
+#define VK_RENDER_GRAPH_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <vktransient.h>
+#include <vector>
+#include <string>
+#include <ostream>
+
+//how a pass touches an image, decides the stage, access and layout it needs
+enum GraphImageUsage
+{
+    GRAPH_COLOR_ATTACHMENT,
+    GRAPH_DEPTH_ATTACHMENT,
+    GRAPH_SAMPLED,
+    GRAPH_STORAGE,
+    GRAPH_TRANSFER_SRC,
+    GRAPH_TRANSFER_DST,
+    GRAPH_PRESENT
+};
+
+struct ImageState
+{
+    VkPipelineStageFlags2 stage;
+    VkAccessFlags2 access;
+    VkImageLayout layout;
+};
+
+ImageState getImageUsageState(GraphImageUsage usage);
+
+//stage and access a layout is normally used with, for one-off transitions outside the graph
+ImageState getLayoutState(VkImageLayout layout);
+
+//records draws or dispatches for one pass, its barriers have already been recorded
+typedef void (*GraphPassFunction)(VkCommandBuffer commandBuffer, void *context);
+
+//Passes declare the images they read and write. compile culls passes nothing
+//depends on, orders the rest by their dependencies, places transient images in
+//aliased memory and works out one batched barrier per pass. execute then only
+//replays that plan, so it does not allocate.
+class RenderGraph
+{
+    public:
+        //drops every pass and image, the transient pool given to compile is left alone
+        void reset();
+
+        //owned outside the graph, e.g. the swapchain image, bound each frame with setImportedImage
+        //initialState is how the image is handed over, e.g. after the acquire semaphore wait
+        uint32_t importImage(const char *name, VkFormat format, VkImageAspectFlags aspectFlags,
+            const ImageState &initialState, VkImageLayout finalLayout);
+
+        //lives only within the frame, usage flags come from the passes that declare it
+        uint32_t createImage(const char *name, uint32_t width, uint32_t height, VkFormat format,
+            VkImageAspectFlags aspectFlags);
+
+        uint32_t addPass(const char *name, GraphPassFunction function, void *context);
+
+        void read(uint32_t pass, uint32_t image, GraphImageUsage usage);
+
+        void write(uint32_t pass, uint32_t image, GraphImageUsage usage);
+
+        //kept even when nothing reads what it writes, e.g. readbacks
+        void setSideEffects(uint32_t pass);
+
+        //what the frame is for, passes that do not lead here are culled
+        void markOutput(uint32_t image);
+
+        void compile(VkDevice &device, VkPhysicalDevice &physicalDevice, TransientImagePool &transientImages);
+
+        void setImportedImage(uint32_t image, VkImage handle, VkImageView view);
+
+        VkImage getImage(uint32_t image) const
+        { return images[image].image; }
+
+        VkImageView getImageView(uint32_t image) const
+        { return images[image].view; }
+
+        void execute(VkCommandBuffer commandBuffer);
+
+        void dump(std::ostream &out) const;
+
+    private:
+        struct Access
+        {
+            uint32_t image;
+            GraphImageUsage usage;
+            bool write;
+        };
+
+        struct Pass
+        {
+            std::string name;
+            GraphPassFunction function;
+            void *context;
+            std::vector<Access> accesses;
+            //passes that have to run first, found from the declared accesses
+            std::vector<uint32_t> dependencies;
+            bool sideEffects;
+            bool culled;
+            uint32_t firstBarrier;
+            uint32_t barrierCount;
+        };
+
+        struct Image
+        {
+            std::string name;
+            bool imported;
+            bool output;
+            uint32_t width;
+            uint32_t height;
+            VkFormat format;
+            VkImageAspectFlags aspectFlags;
+            VkImageUsageFlags usage;
+            ImageState initialState;
+            VkImageLayout finalLayout;
+            VkImage image;
+            VkImageView view;
+            uint32_t transientIndex;
+            //positions in the compiled order, UINT32_MAX when no kept pass uses it
+            uint32_t firstUse;
+            uint32_t lastUse;
+        };
+
+        struct Barrier
+        {
+            uint32_t image;
+            ImageState from;
+            ImageState to;
+        };
+
+        std::vector<Image> images;
+        std::vector<Pass> passes;
+        //kept passes in execution order
+        std::vector<uint32_t> order;
+        //per pass barriers back to back, the final transitions to each image's finalLayout last
+        std::vector<Barrier> barriers;
+        uint32_t firstFinalBarrier = 0;
+        uint32_t finalBarrierCount = 0;
+        uint32_t aliasedImages = 0;
+
+        //filled in execute, sized in compile
+        std::vector<VkImageMemoryBarrier2> scratchBarriers;
+
+        void cullPasses();
+
+        void sortPasses();
+
+        void allocateTransients(VkDevice &device, VkPhysicalDevice &physicalDevice,
+            TransientImagePool &transientImages);
+
+        void computeBarriers(const TransientImagePool &transientImages);
+
+        void recordBarriers(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count);
+};
+
+#endif
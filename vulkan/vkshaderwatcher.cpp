@@ -0,0 +1,168 @@
+#include <vkshaderwatcher.h>
+#include <utils.h>
+#include <stdexcept>
+#include <iostream>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+//editors save in bursts, no point looking more often than this
+static const std::chrono::milliseconds CHECK_INTERVAL(250);
+
+//ships with the vulkan sdk, has to be on the path or next to the executable
+#ifdef _WIN32
+static const char *SHADERC_LIBRARY = "shaderc_shared.dll";
+#else
+static const char *SHADERC_LIBRARY = "libshaderc_shared.so";
+#endif
+
+template<typename T>
+static void loadFunction(void *library, const char *name, T &function)
+{
+#ifdef _WIN32
+    function = reinterpret_cast<T>(GetProcAddress(static_cast<HMODULE>(library), name));
+#else
+    function = reinterpret_cast<T>(dlsym(library, name));
+#endif
+
+    if(function == nullptr)
+    { throw std::runtime_error("failed to load " + std::string(name) + " from " + SHADERC_LIBRARY); }
+}
+
+void ShaderWatcher::loadShaderc()
+{
+#ifdef _WIN32
+    library = LoadLibraryA(SHADERC_LIBRARY);
+#else
+    library = dlopen(SHADERC_LIBRARY, RTLD_NOW);
+#endif
+
+    if(library == nullptr)
+    { throw std::runtime_error("failed to load " + std::string(SHADERC_LIBRARY) + ", hot reload needs it from the vulkan sdk"); }
+
+    loadFunction(library, "shaderc_compiler_initialize", shaderc.compilerInitialize);
+    loadFunction(library, "shaderc_compiler_release", shaderc.compilerRelease);
+    loadFunction(library, "shaderc_compile_options_initialize", shaderc.compileOptionsInitialize);
+    loadFunction(library, "shaderc_compile_options_release", shaderc.compileOptionsRelease);
+    loadFunction(library, "shaderc_compile_options_set_target_env", shaderc.compileOptionsSetTargetEnv);
+    loadFunction(library, "shaderc_compile_into_spv", shaderc.compileIntoSpv);
+    loadFunction(library, "shaderc_result_get_compilation_status", shaderc.resultGetCompilationStatus);
+    loadFunction(library, "shaderc_result_get_bytes", shaderc.resultGetBytes);
+    loadFunction(library, "shaderc_result_get_length", shaderc.resultGetLength);
+    loadFunction(library, "shaderc_result_get_error_message", shaderc.resultGetErrorMessage);
+    loadFunction(library, "shaderc_result_release", shaderc.resultRelease);
+}
+
+void ShaderWatcher::create()
+{
+    loadShaderc();
+
+    compiler = shaderc.compilerInitialize();
+    options = shaderc.compileOptionsInitialize();
+
+    if(compiler == nullptr || options == nullptr)
+    { throw std::runtime_error("failed to initialize shader compiler"); }
+
+    //the api version the device is created with
+    shaderc.compileOptionsSetTargetEnv(options, shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+}
+
+void ShaderWatcher::destroy()
+{
+    if(options != nullptr) shaderc.compileOptionsRelease(options);
+    if(compiler != nullptr) shaderc.compilerRelease(compiler);
+
+    options = nullptr;
+    compiler = nullptr;
+    shaders.clear();
+
+    if(library != nullptr)
+    {
+#ifdef _WIN32
+        FreeLibrary(static_cast<HMODULE>(library));
+#else
+        dlclose(library);
+#endif
+    }
+
+    library = nullptr;
+    shaderc = {};
+}
+
+uint32_t ShaderWatcher::watch(const std::string &path, VkShaderStageFlagBits stage)
+{
+    Shader shader{};
+    shader.path = path;
+
+    if(stage == VK_SHADER_STAGE_VERTEX_BIT) shader.kind = shaderc_vertex_shader;
+    else if(stage == VK_SHADER_STAGE_FRAGMENT_BIT) shader.kind = shaderc_fragment_shader;
+    else if(stage == VK_SHADER_STAGE_COMPUTE_BIT) shader.kind = shaderc_compute_shader;
+    else
+    { throw std::runtime_error("unsupported shader stage for " + path); }
+
+    std::error_code error;
+    shader.writeTime = std::filesystem::last_write_time(path, error);
+
+    shaders.push_back(shader);
+
+    return static_cast<uint32_t>(shaders.size() - 1);
+}
+
+void ShaderWatcher::poll(std::vector<uint32_t> &reloaded)
+{
+    reloaded.clear();
+
+    auto now = std::chrono::steady_clock::now();
+    if(now - lastCheck < CHECK_INTERVAL) return;
+
+    lastCheck = now;
+
+    for(uint32_t i = 0; i < shaders.size(); i++)
+    {
+        Shader &shader = shaders[i];
+
+        //missing for a moment while some editors save
+        std::error_code error;
+        std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(shader.path, error);
+        if(error || writeTime == shader.writeTime) continue;
+
+        //a failed compile is not retried until the file changes again
+        shader.writeTime = writeTime;
+
+        if(compile(shader)) reloaded.push_back(i);
+    }
+}
+
+bool ShaderWatcher::compile(Shader &shader)
+{
+    std::vector<char> source;
+    try
+    {
+        source = readFile(shader.path);
+    }
+    catch(const std::exception &e)
+    {
+        std::cout << "shader reload: " << shader.path << ", " << e.what() << std::endl;
+        return false;
+    }
+
+    shaderc_compilation_result_t result = shaderc.compileIntoSpv(compiler, source.data(), source.size(),
+        shader.kind, shader.path.c_str(), "main", options);
+
+    bool success = shaderc.resultGetCompilationStatus(result) == shaderc_compilation_status_success;
+
+    if(success)
+    {
+        const uint32_t *code = reinterpret_cast<const uint32_t*>(shaderc.resultGetBytes(result));
+        shader.spirv.assign(code, code + shaderc.resultGetLength(result) / sizeof(uint32_t));
+    }
+    else
+    { std::cout << "shader reload: " << shaderc.resultGetErrorMessage(result) << std::endl; }
+
+    shaderc.resultRelease(result);
+
+    return success;
+}
@@ -0,0 +1,73 @@
+#ifndef VK_SHADER_WATCHER_H
+#define VK_SHADER_WATCHER_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <shaderc/shaderc.h>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <filesystem>
+
+//Watches GLSL sources and recompiles them in-process with shaderc when they
+//change on disk. Sources are checked by modification time a few times a second.
+//A source that fails to compile is reported and keeps its last good SPIR-V.
+//shaderc_shared is loaded in create rather than linked, so the executable only
+//needs it at runtime when a watcher is used.
+class ShaderWatcher
+{
+    public:
+        void create();
+
+        void destroy();
+
+        //the source is not compiled until it changes, the build's SPIR-V stays in use until then
+        uint32_t watch(const std::string &path, VkShaderStageFlagBits stage);
+
+        //fills reloaded with the sources that changed and compiled since the last call
+        void poll(std::vector<uint32_t> &reloaded);
+
+        const std::vector<uint32_t> &getSpirv(uint32_t shader) const
+        { return shaders[shader].spirv; }
+
+        const std::string &getPath(uint32_t shader) const
+        { return shaders[shader].path; }
+
+    private:
+        struct Shader
+        {
+            std::string path;
+            shaderc_shader_kind kind;
+            std::filesystem::file_time_type writeTime;
+            std::vector<uint32_t> spirv;
+        };
+
+        //the shaderc functions used, looked up in the library by name
+        struct Shaderc
+        {
+            decltype(&shaderc_compiler_initialize) compilerInitialize;
+            decltype(&shaderc_compiler_release) compilerRelease;
+            decltype(&shaderc_compile_options_initialize) compileOptionsInitialize;
+            decltype(&shaderc_compile_options_release) compileOptionsRelease;
+            decltype(&shaderc_compile_options_set_target_env) compileOptionsSetTargetEnv;
+            decltype(&shaderc_compile_into_spv) compileIntoSpv;
+            decltype(&shaderc_result_get_compilation_status) resultGetCompilationStatus;
+            decltype(&shaderc_result_get_bytes) resultGetBytes;
+            decltype(&shaderc_result_get_length) resultGetLength;
+            decltype(&shaderc_result_get_error_message) resultGetErrorMessage;
+            decltype(&shaderc_result_release) resultRelease;
+        };
+
+        void *library = nullptr;
+        Shaderc shaderc{};
+        shaderc_compiler_t compiler = nullptr;
+        shaderc_compile_options_t options = nullptr;
+        std::vector<Shader> shaders;
+        std::chrono::steady_clock::time_point lastCheck;
+
+        void loadShaderc();
+
+        bool compile(Shader &shader);
+};
+
+#endif
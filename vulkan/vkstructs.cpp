@@ -3,6 +3,7 @@
 #include <limits>
 #include <algorithm>
 #include <vector>
+#include <iterator>
 
 static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
             VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -37,7 +38,7 @@ void populateAppInfo(VkApplicationInfo &appInfo)
     appInfo.applicationVersion = VK_MAKE_VERSION(1,0,0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1,0,0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_3;
 }
 
 void populateQueueCreateInfo(VkDeviceQueueCreateInfo &createInfo, 
@@ -55,10 +56,12 @@ void populateDeviceCreateInfo(VkDeviceCreateInfo &createInfo,
     const VkPhysicalDeviceFeatures &deviceFeatures,
     const std::vector<const char*> &deviceExtensions,
     const bool &enableValidationLayers,
-    const std::vector<const char*> &validationLayers)
+    const std::vector<const char*> &validationLayers,
+    const void *featureChain)
 {
     createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = featureChain;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
@@ -89,14 +92,30 @@ VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>
     return availableFormats[0];
 }
 
-VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR> availablePresentModes)
+static bool hasPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes,
+    VkPresentModeKHR presentMode)
 {
     for(const auto& availablePresentMode : availablePresentModes)
     {
-        if(availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-        { return availablePresentMode; }
+        if(availablePresentMode == presentMode)
+        { return true; }
     }
 
+    return false;
+}
+
+VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR> availablePresentModes,
+    VkPresentModeKHR preferredPresentMode)
+{
+    if(hasPresentMode(availablePresentModes, preferredPresentMode))
+    { return preferredPresentMode; }
+
+    //unthrottled was asked for, mailbox is the closest thing that doesn't tear
+    if(preferredPresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR 
+        && hasPresentMode(availablePresentModes, VK_PRESENT_MODE_MAILBOX_KHR))
+    { return VK_PRESENT_MODE_MAILBOX_KHR; }
+
+    //fifo is the only mode every implementation has to support
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -130,11 +149,12 @@ void populateSwapchainCreateInfo(VkSwapchainCreateInfoKHR &createInfo,
     const VkSurfaceCapabilitiesKHR &capabilities,
     const int &width, const int &height, const uint32_t &imageCount,
     const VkSurfaceKHR &surface, uint32_t *queueFamilyIndices,
-    VkFormat &outFormat, VkExtent2D &outExtent)
+    VkPresentModeKHR preferredPresentMode, VkSwapchainKHR oldSwapchain,
+    VkFormat &outFormat, VkExtent2D &outExtent, VkPresentModeKHR &outPresentMode)
 {
     createInfo = {};
     VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(formats);
-    VkPresentModeKHR presentMode = chooseSwapPresentMode(presentModes);
+    VkPresentModeKHR presentMode = chooseSwapPresentMode(presentModes, preferredPresentMode);
     VkExtent2D extent = chooseSwapExtent(capabilities, width, height);
 
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -163,10 +183,11 @@ void populateSwapchainCreateInfo(VkSwapchainCreateInfoKHR &createInfo,
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = oldSwapchain;
 
     outFormat = surfaceFormat.format;
     outExtent = extent;
+    outPresentMode = presentMode;
 }
 
 void populateImageViewCreateInfo(VkImageViewCreateInfo &createInfo,
@@ -188,62 +209,46 @@ void populateImageViewCreateInfo(VkImageViewCreateInfo &createInfo,
     createInfo.subresourceRange.layerCount = 1;
 }
 
-void populateColorAttachment(VkAttachmentDescription &attachment, VkFormat &imageFormat)
+//attachments are cleared on load, transitions around rendering are recorded by the render graph
+void populateRenderingAttachmentInfo(VkRenderingAttachmentInfo &attachment, VkImageView imageView,
+    VkImageLayout layout, VkAttachmentStoreOp storeOp, const VkClearValue &clearValue)
 {
     attachment = {};
-    attachment.format = imageFormat;
-    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    attachment.imageView = imageView;
+    attachment.imageLayout = layout;
+    attachment.resolveMode = VK_RESOLVE_MODE_NONE;
     attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-}
-
-void populateColorAttachmentRef(VkAttachmentReference &colorAttachmentRef)
-{
-    colorAttachmentRef = {};
-    colorAttachmentRef.attachment = 0;
-    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-}
-
-void populateSubpass(VkSubpassDescription &subpass, 
-    VkAttachmentReference &colorAttachmentRef, VkAttachmentReference &depthAttachmentRef)
-{
-    subpass = {};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
-    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+    attachment.storeOp = storeOp;
+    attachment.clearValue = clearValue;
 }
 
-void populateSubpassDependency(VkSubpassDependency &dependency)
+void populateRenderingInfo(VkRenderingInfo &renderingInfo, VkExtent2D extent, VkRenderingFlags flags,
+    const VkRenderingAttachmentInfo &colorAttachment, const VkRenderingAttachmentInfo &depthAttachment)
 {
-    dependency = {};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
-        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.flags = flags;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.viewMask = 0;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    renderingInfo.pDepthAttachment = &depthAttachment;
+    renderingInfo.pStencilAttachment = nullptr;
 }
 
-void populateRenderPassCreateInfo(VkRenderPassCreateInfo &createInfo,
-    std::array<VkAttachmentDescription, 2> &attachments, VkSubpassDescription &subpass,
-    VkSubpassDependency &dependency)
+void populatePipelineRenderingCreateInfo(VkPipelineRenderingCreateInfo &renderingCreateInfo,
+    const VkFormat &colorFormat, VkFormat depthFormat)
 {
-    createInfo = {};
-    createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    createInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-    createInfo.pAttachments = attachments.data();
-    createInfo.subpassCount = 1;
-    createInfo.pSubpasses = &subpass;
-    createInfo.dependencyCount = 1;
-    createInfo.pDependencies = &dependency;
+    renderingCreateInfo = {};
+    renderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    renderingCreateInfo.viewMask = 0;
+    renderingCreateInfo.colorAttachmentCount = 1;
+    renderingCreateInfo.pColorAttachmentFormats = &colorFormat;
+    renderingCreateInfo.depthAttachmentFormat = depthFormat;
+    renderingCreateInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
 }
 
 void populateVertShaderStageCreateInfo(VkPipelineShaderStageCreateInfo &vertShaderStageInfo,
@@ -277,7 +282,7 @@ void populatePipelineDynamicStateCreateInfo(VkPipelineDynamicStateCreateInfo &dy
 
 void populatePipelineVertexInputStateCreateInfo(VkPipelineVertexInputStateCreateInfo &vertexInputInfo,
     VkVertexInputBindingDescription &vertexBindingDescription, 
-    std::array<VkVertexInputAttributeDescription, 3> &vertexAttributeDescriptions)
+    std::array<VkVertexInputAttributeDescription, SHADER_VERTEX_ATTRIBUTE_COUNT> &vertexAttributeDescriptions)
 {
     vertexInputInfo = {};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -382,15 +387,33 @@ void populatePipelineColorBlendStateCreateInfo(VkPipelineColorBlendStateCreateIn
     colorBlending.blendConstants[3] = 0.0f;
 }
 
+void populateSpecializationInfo(VkSpecializationInfo &specializationInfo, uint32_t mapEntryCount,
+    const VkSpecializationMapEntry *mapEntries, size_t dataSize, const void *data)
+{
+    specializationInfo = {};
+    specializationInfo.mapEntryCount = mapEntryCount;
+    specializationInfo.pMapEntries = mapEntries;
+    specializationInfo.dataSize = dataSize;
+    specializationInfo.pData = data;
+}
+
+void populatePushConstantRange(VkPushConstantRange &pushConstantRange, VkShaderStageFlags stages, uint32_t size)
+{
+    pushConstantRange = {};
+    pushConstantRange.stageFlags = stages;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = size;
+}
+
 void populatePipelineLayoutCreateInfo(VkPipelineLayoutCreateInfo &pipelineLayoutInfo,
-    VkDescriptorSetLayout &descriptorSetLayout)
+    VkDescriptorSetLayout &descriptorSetLayout, VkPushConstantRange &pushConstantRange)
 {
     pipelineLayoutInfo = {};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = 1;
     pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 }
 
 void populateVertexBufferCreateInfo(VkBufferCreateInfo &bufferInfo,
@@ -413,18 +436,8 @@ void populateBufferCreateInfo(VkBufferCreateInfo &bufferInfo, VkDeviceSize &size
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 }
 
-void populateUniformBufferObjectLayoutBinding(VkDescriptorSetLayoutBinding &uboLayoutBinding)
-{
-    uboLayoutBinding = {};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-    uboLayoutBinding.pImmutableSamplers = nullptr;
-}
-
 void populateDescriptorSetLayoutCreateInfo(VkDescriptorSetLayoutCreateInfo &layoutInfo,
-    std::array<VkDescriptorSetLayoutBinding, 2> &layoutBindings)
+    std::array<VkDescriptorSetLayoutBinding, SHADER_DESCRIPTOR_BINDING_COUNT> &layoutBindings)
 {
     layoutInfo = {};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -432,24 +445,67 @@ void populateDescriptorSetLayoutCreateInfo(VkDescriptorSetLayoutCreateInfo &layo
     layoutInfo.pBindings = layoutBindings.data();
 }
 
-void populateWriteDescriptorSet(std::array<VkWriteDescriptorSet, 2> &descriptorWrites, 
-    VkDescriptorSet &descriptorSet, VkDescriptorBufferInfo &bufferInfo, VkDescriptorImageInfo &imageInfo)
+static constexpr bool isBufferDescriptor(VkDescriptorType type)
 {
-    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[0].dstSet = descriptorSet;
-    descriptorWrites[0].dstBinding = 0;
-    descriptorWrites[0].dstArrayElement = 0;
-    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorWrites[0].descriptorCount = 1;
-    descriptorWrites[0].pBufferInfo = &bufferInfo;
+    return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+        type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+}
+
+static constexpr bool isImageDescriptor(VkDescriptorType type)
+{
+    return type == VK_DESCRIPTOR_TYPE_SAMPLER || type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+        type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+        type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+}
+
+//descriptors the shaders read from buffers, or from images when buffers is false
+static constexpr uint32_t countDescriptors(bool buffers)
+{
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < SHADER_DESCRIPTOR_BINDING_COUNT; i++)
+    {
+        VkDescriptorType type = SHADER_DESCRIPTOR_BINDINGS[i].descriptorType;
+        if(buffers ? isBufferDescriptor(type) : isImageDescriptor(type))
+        { count += SHADER_DESCRIPTOR_BINDINGS[i].descriptorCount; }
+    }
+    return count;
+}
+
+//the writes only have the uniform ring and the texture to point at
+static_assert(std::size(SHADER_DESCRIPTOR_BINDINGS) == SHADER_DESCRIPTOR_BINDING_COUNT,
+    "SHADER_DESCRIPTOR_BINDING_COUNT does not match SHADER_DESCRIPTOR_BINDINGS");
+static_assert(countDescriptors(true) == 1, "the shaders must read exactly one buffer, the uniform ring");
+static_assert(countDescriptors(false) == 1, "the shaders must read exactly one image, the texture");
+static_assert(countDescriptors(true) + countDescriptors(false) == SHADER_DESCRIPTOR_BINDING_COUNT,
+    "the shaders use a descriptor type there is nothing to write for");
+
+VkDescriptorType getBoundDescriptorType(VkDescriptorType reflectedType)
+{
+    if(reflectedType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+
+    return reflectedType;
+}
 
-    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[1].dstSet = descriptorSet;
-    descriptorWrites[1].dstBinding = 1;
-    descriptorWrites[1].dstArrayElement = 0;
-    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptorWrites[1].descriptorCount = 1;
-    descriptorWrites[1].pImageInfo = &imageInfo;
+void populateWriteDescriptorSet(std::array<VkWriteDescriptorSet, SHADER_DESCRIPTOR_BINDING_COUNT> &descriptorWrites,
+    VkDescriptorSet &descriptorSet, VkDescriptorBufferInfo &bufferInfo, VkDescriptorImageInfo &imageInfo)
+{
+    for(uint32_t i = 0; i < SHADER_DESCRIPTOR_BINDING_COUNT; i++)
+    {
+        const VkDescriptorSetLayoutBinding &binding = SHADER_DESCRIPTOR_BINDINGS[i];
+
+        descriptorWrites[i] = {};
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = descriptorSet;
+        descriptorWrites[i].dstBinding = binding.binding;
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType = getBoundDescriptorType(binding.descriptorType);
+        descriptorWrites[i].descriptorCount = binding.descriptorCount;
+
+        if(isBufferDescriptor(binding.descriptorType))
+        { descriptorWrites[i].pBufferInfo = &bufferInfo; }
+        else
+        { descriptorWrites[i].pImageInfo = &imageInfo; }
+    }
 }
 
 void populateImageCreateInfo(VkImageCreateInfo &imageInfo, uint32_t width, uint32_t height,
@@ -472,23 +528,35 @@ void populateImageCreateInfo(VkImageCreateInfo &imageInfo, uint32_t width, uint3
     imageInfo.flags = 0;
 }
 
-void populateImageMemoryBarrier(VkImageMemoryBarrier &barrier,
-    VkImageLayout &oldLayout, VkImageLayout &newLayout, VkImage &image)
+void populateImageMemoryBarrier2(VkImageMemoryBarrier2 &barrier, VkImage image, VkImageAspectFlags aspectFlags,
+    VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkImageLayout oldLayout,
+    VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, VkImageLayout newLayout)
 {
     barrier = {};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = srcStage;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = dstStage;
+    barrier.dstAccessMask = dstAccess;
     barrier.oldLayout = oldLayout;
     barrier.newLayout = newLayout;
     barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.image = image;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.aspectMask = aspectFlags;
     barrier.subresourceRange.baseMipLevel = 0;
     barrier.subresourceRange.levelCount = 1;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = 0;
+}
+
+void populateDependencyInfo(VkDependencyInfo &dependencyInfo, uint32_t imageBarrierCount,
+    const VkImageMemoryBarrier2 *imageBarriers)
+{
+    dependencyInfo = {};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.imageMemoryBarrierCount = imageBarrierCount;
+    dependencyInfo.pImageMemoryBarriers = imageBarriers;
 }
 
 void populateSamplerCreateInfo(VkSamplerCreateInfo &samplerInfo, float maxAnisotropy)
@@ -512,26 +580,6 @@ void populateSamplerCreateInfo(VkSamplerCreateInfo &samplerInfo, float maxAnisot
     samplerInfo.maxLod = 0.0f;
 }
 
-void populateDepthAttachment(VkAttachmentDescription &depthAttachment, VkFormat format)
-{
-    depthAttachment = {};
-    depthAttachment.format = format;
-    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-}
-
-void populateDepthAttachmentRef(VkAttachmentReference &depthAttachmentRef)
-{
-    depthAttachmentRef = {};
-    depthAttachmentRef.attachment = 1;
-    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-}
-
 void populatePipelineDepthStencilStateCreateInfo(VkPipelineDepthStencilStateCreateInfo &depthStencil)
 {
     depthStencil = {};
@@ -545,4 +593,77 @@ void populatePipelineDepthStencilStateCreateInfo(VkPipelineDepthStencilStateCrea
     depthStencil.stencilTestEnable = VK_FALSE;
     depthStencil.front = {};
     depthStencil.back = {};
+}
+
+void populateTimelineSemaphoreTypeCreateInfo(VkSemaphoreTypeCreateInfo &typeInfo, uint64_t initialValue)
+{
+    typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = initialValue;
+}
+
+void populateTimelineSemaphoreSubmitInfo(VkTimelineSemaphoreSubmitInfo &timelineInfo,
+    uint32_t waitValueCount, const uint64_t *waitValues,
+    uint32_t signalValueCount, const uint64_t *signalValues)
+{
+    timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = waitValueCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+    timelineInfo.signalSemaphoreValueCount = signalValueCount;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+}
+
+void populateSemaphoreWaitInfo(VkSemaphoreWaitInfo &waitInfo, VkSemaphore &semaphore, uint64_t &value)
+{
+    waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &semaphore;
+    waitInfo.pValues = &value;
+}
+
+void populateGraphicsPipelineLibraryCreateInfo(VkGraphicsPipelineLibraryCreateInfoEXT &libraryInfo,
+    VkGraphicsPipelineLibraryFlagsEXT parts, const void *next)
+{
+    libraryInfo = {};
+    libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+    libraryInfo.pNext = next;
+    libraryInfo.flags = parts;
+}
+
+void populatePipelineLibraryCreateInfo(VkPipelineLibraryCreateInfoKHR &libraryInfo,
+    uint32_t libraryCount, const VkPipeline *libraries)
+{
+    libraryInfo = {};
+    libraryInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    libraryInfo.libraryCount = libraryCount;
+    libraryInfo.pLibraries = libraries;
+}
+
+void populateCommandBufferInheritanceRenderingInfo(VkCommandBufferInheritanceRenderingInfo &renderingInfo,
+    const VkFormat &colorFormat, VkFormat depthFormat)
+{
+    renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    renderingInfo.flags = 0;
+    renderingInfo.viewMask = 0;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &colorFormat;
+    renderingInfo.depthAttachmentFormat = depthFormat;
+    renderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+    renderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+}
+
+//no render pass or framebuffer, the rendering info describes the attachments instead
+void populateCommandBufferInheritanceInfo(VkCommandBufferInheritanceInfo &inheritanceInfo,
+    VkCommandBufferInheritanceRenderingInfo &renderingInfo)
+{
+    inheritanceInfo = {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = &renderingInfo;
+    inheritanceInfo.renderPass = VK_NULL_HANDLE;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = VK_NULL_HANDLE;
 }
\ No newline at end of file
@@ -19,7 +19,8 @@ void populateDeviceCreateInfo(VkDeviceCreateInfo &createInfo,
     const VkPhysicalDeviceFeatures &deviceFeatures,
     const std::vector<const char*> &deviceExtensions,
     const bool &enableValidationLayers,
-    const std::vector<const char*> &validationLayers);
+    const std::vector<const char*> &validationLayers,
+    const void *featureChain);
 
 void populateSwapchainCreateInfo(VkSwapchainCreateInfoKHR &createInfo, 
     const std::vector<VkSurfaceFormatKHR> &formats,
@@ -27,23 +28,20 @@ void populateSwapchainCreateInfo(VkSwapchainCreateInfoKHR &createInfo,
     const VkSurfaceCapabilitiesKHR &capabilities,
     const int &width, const int &height, const uint32_t &imageCount,
     const VkSurfaceKHR &surface, uint32_t* queueFamilyIndices,
-    VkFormat &outFormat, VkExtent2D &outExtent);
+    VkPresentModeKHR preferredPresentMode, VkSwapchainKHR oldSwapchain,
+    VkFormat &outFormat, VkExtent2D &outExtent, VkPresentModeKHR &outPresentMode);
 
 void populateImageViewCreateInfo(VkImageViewCreateInfo &createInfo,
     VkImage &image, VkFormat &imageFormat, VkImageAspectFlags &aspectFlags);
 
-void populateColorAttachment(VkAttachmentDescription &attachment, VkFormat &imageFormat);
+void populateRenderingAttachmentInfo(VkRenderingAttachmentInfo &attachment, VkImageView imageView,
+    VkImageLayout layout, VkAttachmentStoreOp storeOp, const VkClearValue &clearValue);
 
-void populateColorAttachmentRef(VkAttachmentReference &colorAttachmentRef);
+void populateRenderingInfo(VkRenderingInfo &renderingInfo, VkExtent2D extent, VkRenderingFlags flags,
+    const VkRenderingAttachmentInfo &colorAttachment, const VkRenderingAttachmentInfo &depthAttachment);
 
-void populateSubpass(VkSubpassDescription &subpass, 
-    VkAttachmentReference &colorAttachmentRef, VkAttachmentReference &depthAttachmentRef);
-
-void populateSubpassDependency(VkSubpassDependency &dependency);
-
-void populateRenderPassCreateInfo(VkRenderPassCreateInfo &createInfo,
-    std::array<VkAttachmentDescription, 2> &attachments, VkSubpassDescription &subpass,
-    VkSubpassDependency &dependency);
+void populatePipelineRenderingCreateInfo(VkPipelineRenderingCreateInfo &renderingCreateInfo,
+    const VkFormat &colorFormat, VkFormat depthFormat);
 
 void populateVertShaderStageCreateInfo(VkPipelineShaderStageCreateInfo &vertShaderStageInfo,
     VkShaderModule &vertShaderModule);
@@ -56,7 +54,7 @@ void populatePipelineDynamicStateCreateInfo(VkPipelineDynamicStateCreateInfo &dy
 
 void populatePipelineVertexInputStateCreateInfo(VkPipelineVertexInputStateCreateInfo &vertexInputInfo,
     VkVertexInputBindingDescription &vertexBindingDescription, 
-    std::array<VkVertexInputAttributeDescription, 3> &vertexAttributeDescriptions);
+    std::array<VkVertexInputAttributeDescription, SHADER_VERTEX_ATTRIBUTE_COUNT> &vertexAttributeDescriptions);
 
 void populatePipelineInputAssemblyStateCreateInfo(VkPipelineInputAssemblyStateCreateInfo &inputAssembly);
 
@@ -76,8 +74,13 @@ void populatePipelineColorBlendAttachmentState(VkPipelineColorBlendAttachmentSta
 void populatePipelineColorBlendStateCreateInfo(VkPipelineColorBlendStateCreateInfo &colorBlending,
     VkPipelineColorBlendAttachmentState &colorBlendAttachment);
 
+void populateSpecializationInfo(VkSpecializationInfo &specializationInfo, uint32_t mapEntryCount,
+    const VkSpecializationMapEntry *mapEntries, size_t dataSize, const void *data);
+
+void populatePushConstantRange(VkPushConstantRange &pushConstantRange, VkShaderStageFlags stages, uint32_t size);
+
 void populatePipelineLayoutCreateInfo(VkPipelineLayoutCreateInfo &pipelineLayoutInfo,
-    VkDescriptorSetLayout &descriptorSetLayout);
+    VkDescriptorSetLayout &descriptorSetLayout, VkPushConstantRange &pushConstantRange);
 
 void populateVertexBufferCreateInfo(VkBufferCreateInfo &bufferInfo,
     const std::vector<Vertex> &vertices);
@@ -85,26 +88,48 @@ void populateVertexBufferCreateInfo(VkBufferCreateInfo &bufferInfo,
 void populateBufferCreateInfo(VkBufferCreateInfo &bufferInfo, VkDeviceSize &size,
     VkBufferUsageFlags &usage);
 
-void populateUniformBufferObjectLayoutBinding(VkDescriptorSetLayoutBinding &uboLayoutBinding);
-
 void populateDescriptorSetLayoutCreateInfo(VkDescriptorSetLayoutCreateInfo &layoutInfo,
-    std::array<VkDescriptorSetLayoutBinding, 2> &layoutBindings);
+    std::array<VkDescriptorSetLayoutBinding, SHADER_DESCRIPTOR_BINDING_COUNT> &layoutBindings);
+
+//uniform buffers are suballocated from the ring, so they are bound with a dynamic offset
+VkDescriptorType getBoundDescriptorType(VkDescriptorType reflectedType);
 
-void populateWriteDescriptorSet(std::array<VkWriteDescriptorSet, 2> &descriptorWrites, 
+//one write per reflected binding, buffers point at bufferInfo and images at imageInfo
+void populateWriteDescriptorSet(std::array<VkWriteDescriptorSet, SHADER_DESCRIPTOR_BINDING_COUNT> &descriptorWrites,
     VkDescriptorSet &descriptorSet, VkDescriptorBufferInfo &bufferInfo, VkDescriptorImageInfo &imageInfo);
 
 void populateImageCreateInfo(VkImageCreateInfo &imageInfo, uint32_t width, uint32_t height,
     VkFormat &format, VkImageTiling &tiling, VkImageUsageFlags &usage);
 
-void populateImageMemoryBarrier(VkImageMemoryBarrier &barrier,
-    VkImageLayout &oldLayout, VkImageLayout &newLayout, VkImage &image);
+void populateImageMemoryBarrier2(VkImageMemoryBarrier2 &barrier, VkImage image, VkImageAspectFlags aspectFlags,
+    VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkImageLayout oldLayout,
+    VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, VkImageLayout newLayout);
+
+void populateDependencyInfo(VkDependencyInfo &dependencyInfo, uint32_t imageBarrierCount,
+    const VkImageMemoryBarrier2 *imageBarriers);
 
 void populateSamplerCreateInfo(VkSamplerCreateInfo &samplerInfo, float maxAnisotropy);
 
-void populateDepthAttachment(VkAttachmentDescription &depthAttachment, VkFormat format);
+void populatePipelineDepthStencilStateCreateInfo(VkPipelineDepthStencilStateCreateInfo &depthStencil);
 
-void populateDepthAttachmentRef(VkAttachmentReference &depthAttachmentRef);
+void populateTimelineSemaphoreTypeCreateInfo(VkSemaphoreTypeCreateInfo &typeInfo, uint64_t initialValue);
 
-void populatePipelineDepthStencilStateCreateInfo(VkPipelineDepthStencilStateCreateInfo &depthStencil);
+void populateTimelineSemaphoreSubmitInfo(VkTimelineSemaphoreSubmitInfo &timelineInfo,
+    uint32_t waitValueCount, const uint64_t *waitValues,
+    uint32_t signalValueCount, const uint64_t *signalValues);
+
+void populateSemaphoreWaitInfo(VkSemaphoreWaitInfo &waitInfo, VkSemaphore &semaphore, uint64_t &value);
+
+void populateGraphicsPipelineLibraryCreateInfo(VkGraphicsPipelineLibraryCreateInfoEXT &libraryInfo,
+    VkGraphicsPipelineLibraryFlagsEXT parts, const void *next);
+
+void populatePipelineLibraryCreateInfo(VkPipelineLibraryCreateInfoKHR &libraryInfo,
+    uint32_t libraryCount, const VkPipeline *libraries);
+
+void populateCommandBufferInheritanceRenderingInfo(VkCommandBufferInheritanceRenderingInfo &renderingInfo,
+    const VkFormat &colorFormat, VkFormat depthFormat);
+
+void populateCommandBufferInheritanceInfo(VkCommandBufferInheritanceInfo &inheritanceInfo,
+    VkCommandBufferInheritanceRenderingInfo &renderingInfo);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include <vktransient.h>
+#include <vkhelpers.h>
+#include <vkstructs.h>
+#include <stdexcept>
+#include <algorithm>
+
+uint32_t TransientImagePool::addImage(uint32_t width, uint32_t height, VkFormat format,
+    VkImageUsageFlags usage, VkImageAspectFlags aspectFlags,
+    uint32_t firstPass, uint32_t lastPass)
+{
+    TransientImage image{};
+    image.width = width;
+    image.height = height;
+    image.format = format;
+    image.usage = usage;
+
+    //only attachment usages may be combined with the transient bit
+    VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT 
+        | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    if((usage & ~attachmentUsage) == 0) image.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+    image.aspectFlags = aspectFlags;
+    image.firstPass = firstPass;
+    image.lastPass = lastPass;
+
+    images.push_back(image);
+
+    return static_cast<uint32_t>(images.size() - 1);
+}
+
+bool TransientImagePool::fitsSlot(const AliasSlot &slot, const TransientImage &image) const
+{
+    for(uint32_t other : slot.images)
+    {
+        if(image.firstPass <= images[other].lastPass
+            && images[other].firstPass <= image.lastPass)
+        { return false; }
+    }
+
+    return true;
+}
+
+void TransientImagePool::allocate(VkDevice &device, VkPhysicalDevice &physicalDevice)
+{
+    std::vector<VkMemoryRequirements> requirements(images.size());
+    std::vector<uint32_t> aliased;
+
+    for(size_t i = 0; i < images.size(); i++)
+    {
+        TransientImage &image = images[i];
+        VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL;
+
+        VkImageCreateInfo imageInfo{};
+        populateImageCreateInfo(imageInfo, image.width, image.height,
+            image.format, tiling, image.usage);
+
+        if(vkCreateImage(device, &imageInfo, nullptr, &image.image) != VK_SUCCESS)
+        { throw std::runtime_error("failed to create transient image"); }
+
+        vkGetImageMemoryRequirements(device, image.image, &requirements[i]);
+        requestedSize += requirements[i].size;
+
+        uint32_t lazyTypeIndex;
+        if(tryFindMemoryType(physicalDevice, requirements[i].memoryTypeBits,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+            lazyTypeIndex))
+        {
+            VkMemoryAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize = requirements[i].size;
+            allocInfo.memoryTypeIndex = lazyTypeIndex;
+
+            VkDeviceMemory memory;
+            if(vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+            { throw std::runtime_error("failed to allocate lazy image memory"); }
+
+            vkBindImageMemory(device, image.image, memory, 0);
+            memories.push_back(memory);
+            memorySizes.push_back(requirements[i].size);
+            image.lazy = true;
+        }
+        else
+        {
+            aliased.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    //biggest first so the smaller images land in slots that are already large enough
+    std::sort(aliased.begin(), aliased.end(), [&](uint32_t a, uint32_t b)
+    { return requirements[a].size > requirements[b].size; });
+
+    for(uint32_t index : aliased)
+    {
+        uint32_t memoryTypeIndex = findMemoryType(physicalDevice,
+            requirements[index].memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        bool placed = false;
+        for(size_t s = 0; s < slots.size(); s++)
+        {
+            if(slots[s].memoryTypeIndex == memoryTypeIndex && fitsSlot(slots[s], images[index]))
+            {
+                slots[s].size = std::max(slots[s].size, requirements[index].size);
+                slots[s].alignment = std::max(slots[s].alignment, requirements[index].alignment);
+                slots[s].images.push_back(index);
+                images[index].slot = static_cast<uint32_t>(s);
+                placed = true;
+                break;
+            }
+        }
+
+        if(!placed)
+        {
+            AliasSlot slot{};
+            slot.memoryTypeIndex = memoryTypeIndex;
+            slot.size = requirements[index].size;
+            slot.alignment = requirements[index].alignment;
+            slot.images.push_back(index);
+            images[index].slot = static_cast<uint32_t>(slots.size());
+            slots.push_back(slot);
+        }
+    }
+
+    //one block per memory type, slots laid out back to back inside it
+    std::vector<bool> handled(slots.size(), false);
+    for(size_t s = 0; s < slots.size(); s++)
+    {
+        if(handled[s]) continue;
+
+        uint32_t memoryTypeIndex = slots[s].memoryTypeIndex;
+        VkDeviceSize blockSize = 0;
+
+        for(size_t t = s; t < slots.size(); t++)
+        {
+            if(slots[t].memoryTypeIndex != memoryTypeIndex) continue;
+
+            VkDeviceSize alignment = slots[t].alignment;
+            slots[t].offset = (blockSize + alignment - 1) / alignment * alignment;
+            blockSize = slots[t].offset + slots[t].size;
+        }
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = blockSize;
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+        VkDeviceMemory memory;
+        if(vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+        { throw std::runtime_error("failed to allocate transient image memory"); }
+
+        memories.push_back(memory);
+        memorySizes.push_back(blockSize);
+        committedSize += blockSize;
+
+        for(size_t t = s; t < slots.size(); t++)
+        {
+            if(slots[t].memoryTypeIndex != memoryTypeIndex) continue;
+
+            for(uint32_t index : slots[t].images)
+            {
+                vkBindImageMemory(device, images[index].image, memory, slots[t].offset);
+            }
+
+            handled[t] = true;
+        }
+    }
+
+    for(TransientImage &image : images)
+    {
+        image.view = createImageView(device, image.image, image.format, image.aspectFlags);
+    }
+}
+
+void TransientImagePool::destroy(VkDevice &device)
+{
+    for(TransientImage &image : images)
+    {
+        vkDestroyImageView(device, image.view, nullptr);
+        vkDestroyImage(device, image.image, nullptr);
+    }
+
+    for(VkDeviceMemory memory : memories)
+    {
+        vkFreeMemory(device, memory, nullptr);
+    }
+
+    images.clear();
+    slots.clear();
+    memories.clear();
+    memorySizes.clear();
+    requestedSize = 0;
+    committedSize = 0;
+}
+
+void TransientImagePool::release(DeletionQueue &deletionQueue, uint64_t value)
+{
+    for(TransientImage &image : images)
+    {
+        deletionQueue.destroyImageView(image.view, value);
+        deletionQueue.destroyImage(image.image, value);
+    }
+
+    for(size_t i = 0; i < memories.size(); i++)
+    {
+        deletionQueue.freeMemory(memories[i], memorySizes[i], value);
+    }
+
+    images.clear();
+    slots.clear();
+    memories.clear();
+    memorySizes.clear();
+    requestedSize = 0;
+    committedSize = 0;
+}
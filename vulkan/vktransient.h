@@ -0,0 +1,81 @@
+#ifndef VK_TRANSIENT_H
+#define VK_TRANSIENT_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <vkdeletionqueue.h>
+#include <vector>
+
+//Images whose contents never outlive the frame. Attachment-only images are
+//created with TRANSIENT_ATTACHMENT usage and placed in LAZILY_ALLOCATED memory
+//when the device has it, otherwise images with disjoint pass lifetimes share
+//the same memory.
+struct TransientImage
+{
+    VkImage image = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    uint32_t width;
+    uint32_t height;
+    VkFormat format;
+    VkImageUsageFlags usage;
+    VkImageAspectFlags aspectFlags;
+    uint32_t firstPass;
+    uint32_t lastPass;
+    uint32_t slot;
+    bool lazy = false;
+};
+
+class TransientImagePool
+{
+    public:
+        uint32_t addImage(uint32_t width, uint32_t height, VkFormat format,
+            VkImageUsageFlags usage, VkImageAspectFlags aspectFlags,
+            uint32_t firstPass, uint32_t lastPass);
+
+        void allocate(VkDevice &device, VkPhysicalDevice &physicalDevice);
+
+        void destroy(VkDevice &device);
+
+        //hands everything to the queue instead of destroying it now, the pool is empty afterwards
+        void release(DeletionQueue &deletionQueue, uint64_t value);
+
+        VkImage getImage(uint32_t index) const
+        { return images[index].image; }
+
+        VkImageView getImageView(uint32_t index) const
+        { return images[index].view; }
+
+        //images sharing a slot share memory, UINT32_MAX for lazily allocated images
+        uint32_t getSlot(uint32_t index) const
+        { return images[index].lazy ? UINT32_MAX : images[index].slot; }
+
+        //bytes the images would need with one allocation each
+        VkDeviceSize getRequestedSize() const
+        { return requestedSize; }
+
+        //bytes actually committed up front (lazy memory is not counted)
+        VkDeviceSize getCommittedSize() const
+        { return committedSize; }
+
+    private:
+        struct AliasSlot
+        {
+            uint32_t memoryTypeIndex;
+            VkDeviceSize offset;
+            VkDeviceSize size;
+            VkDeviceSize alignment;
+            std::vector<uint32_t> images;
+        };
+
+        std::vector<TransientImage> images;
+        std::vector<AliasSlot> slots;
+        std::vector<VkDeviceMemory> memories;
+        std::vector<VkDeviceSize> memorySizes;
+
+        VkDeviceSize requestedSize = 0;
+        VkDeviceSize committedSize = 0;
+
+        bool fitsSlot(const AliasSlot &slot, const TransientImage &image) const;
+};
+
+#endif
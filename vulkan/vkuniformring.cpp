@@ -0,0 +1,70 @@
+#include <vkuniformring.h>
+#include <vkhelpers.h>
+#include <stdexcept>
+#include <string.h>
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void UniformRing::create(VkDevice &device, VkPhysicalDevice &physicalDevice,
+    uint32_t frameCount, VkDeviceSize capacity)
+{
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    alignment = properties.limits.minUniformBufferOffsetAlignment;
+    if(alignment == 0) alignment = 1;
+
+    frameCapacity = alignUp(capacity, alignment);
+    frameBase = 0;
+    head = 0;
+
+    createBuffer(device, physicalDevice, frameCapacity * frameCount,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        buffer, memory);
+
+    void *data;
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+    mapped = static_cast<uint8_t*>(data);
+}
+
+void UniformRing::destroy(VkDevice &device)
+{
+    vkUnmapMemory(device, memory);
+    vkDestroyBuffer(device, buffer, nullptr);
+    vkFreeMemory(device, memory, nullptr);
+
+    buffer = VK_NULL_HANDLE;
+    memory = VK_NULL_HANDLE;
+    mapped = nullptr;
+}
+
+void UniformRing::beginFrame(uint32_t frameIndex)
+{
+    frameBase = frameCapacity * frameIndex;
+    head = frameBase;
+}
+
+void* UniformRing::allocate(VkDeviceSize size, uint32_t &dynamicOffset)
+{
+    VkDeviceSize offset = alignUp(head, alignment);
+
+    if(offset + size > frameBase + frameCapacity)
+    { throw std::runtime_error("uniform ring buffer exhausted"); }
+
+    head = offset + size;
+    dynamicOffset = static_cast<uint32_t>(offset);
+
+    return mapped + offset;
+}
+
+uint32_t UniformRing::push(const void *data, VkDeviceSize size)
+{
+    uint32_t dynamicOffset;
+    memcpy(allocate(size, dynamicOffset), data, static_cast<size_t>(size));
+
+    return dynamicOffset;
+}
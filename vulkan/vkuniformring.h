@@ -0,0 +1,47 @@
+#ifndef VK_UNIFORM_RING_H
+#define VK_UNIFORM_RING_H
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_core.h>
+#define GLFW_INCLUDE_VULKAN
+#include <cstdint>
+
+//One persistently mapped uniform buffer split into a region per frame in flight.
+//Constants are bump-allocated inside the current frame's region and bound
+//with UNIFORM_BUFFER_DYNAMIC descriptors, so every draw shares a single
+//descriptor set and only changes its dynamic offsets.
+class UniformRing
+{
+    public:
+        void create(VkDevice &device, VkPhysicalDevice &physicalDevice,
+            uint32_t frameCount, VkDeviceSize frameCapacity);
+
+        void destroy(VkDevice &device);
+
+        //the frame's previous contents must no longer be read by the GPU
+        void beginFrame(uint32_t frameIndex);
+
+        void* allocate(VkDeviceSize size, uint32_t &dynamicOffset);
+
+        uint32_t push(const void *data, VkDeviceSize size);
+
+        VkBuffer getBuffer() const
+        { return buffer; }
+
+        VkDeviceSize getAlignment() const
+        { return alignment; }
+
+        VkDeviceSize getFrameUsage() const
+        { return head - frameBase; }
+
+    private:
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        uint8_t *mapped = nullptr;
+
+        VkDeviceSize alignment = 1;
+        VkDeviceSize frameCapacity = 0;
+        VkDeviceSize frameBase = 0;
+        VkDeviceSize head = 0;
+};
+
+#endif
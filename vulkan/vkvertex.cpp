@@ -1,32 +1,26 @@
 #include <vkvertex.h>
 
+//the shader's inputs are generated, Vertex has to keep matching them
+static_assert(sizeof(Vertex) == SHADER_VERTEX_STRIDE, "Vertex does not match the vertex shader's inputs");
+static_assert(offsetof(Vertex, pos) == SHADER_VERTEX_ATTRIBUTES[0].offset, "Vertex::pos is not at location 0");
+static_assert(offsetof(Vertex, color) == SHADER_VERTEX_ATTRIBUTES[1].offset, "Vertex::color is not at location 1");
+static_assert(offsetof(Vertex, texCoord) == SHADER_VERTEX_ATTRIBUTES[2].offset, "Vertex::texCoord is not at location 2");
+
 VkVertexInputBindingDescription Vertex::getBindingDescription()
 {
     VkVertexInputBindingDescription bindingDescription;
     bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Vertex);
+    bindingDescription.stride = SHADER_VERTEX_STRIDE;
     bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
     return bindingDescription;
 }
 
-std::array<VkVertexInputAttributeDescription, 3> Vertex::getAttributeDescriptions()
+std::array<VkVertexInputAttributeDescription, SHADER_VERTEX_ATTRIBUTE_COUNT> Vertex::getAttributeDescriptions()
 {
-    std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
-
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(Vertex, pos);
-
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(Vertex, color);
+    std::array<VkVertexInputAttributeDescription, SHADER_VERTEX_ATTRIBUTE_COUNT> attributeDescriptions{};
 
-    attributeDescriptions[2].binding = 0;
-    attributeDescriptions[2].location = 2;
-    attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
+    for(uint32_t i = 0; i < SHADER_VERTEX_ATTRIBUTE_COUNT; i++)
+    { attributeDescriptions[i] = SHADER_VERTEX_ATTRIBUTES[i]; }
 
     return attributeDescriptions;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #define GLFW_INCLUDE_VULKAN
 #include <array>
 #include <glm.hpp>
+#include <shaders/shaderlayout.h>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
@@ -16,7 +17,7 @@ struct Vertex
 
     static VkVertexInputBindingDescription getBindingDescription();
 
-    static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions();
+    static std::array<VkVertexInputAttributeDescription, SHADER_VERTEX_ATTRIBUTE_COUNT> getAttributeDescriptions();
 
     bool operator==(const Vertex& other) const 
     {
@@ -10,11 +10,28 @@
 #include <stb_image.h>
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
+#include <shaders/shaderlayout.h>
+#include <shaders/shaderbinaries.h>
 #include <vkstructs.h>
 #include <vkdebug.h>
 #include <vkvertex.h>
 #include <vkhelpers.h>
+#include <vktransient.h>
+#include <vkuniformring.h>
+#include <vkallocator.h>
+#include <vkdefrag.h>
+#include <vkdeletionqueue.h>
+#include <vkrecorder.h>
+#include <vkpresenttimer.h>
+#include <vkrendergraph.h>
+#include <vkpipelinecache.h>
+#include <vkpipelinecompiler.h>
+#include <vkshaderwatcher.h>
 #include <utils.h>
+#include <framearena.h>
+#include <heapcounter.h>
+#include <framelimiter.h>
+#include <snapshotring.h>
 #include <stdexcept>
 #include <vector>
 #include <set>
@@ -22,10 +39,16 @@
 #include <unordered_map>
 #include <iostream>
 #include <string.h>
+#include <stdio.h>
+#include <cmath>
 #include <optional>
 #include <limits>
 #include <algorithm>
 #include <chrono>
+#include <thread>
+#include <atomic>
+
+static_assert(SHADER_BINARIES_SPIRV_HASH == SHADER_LAYOUT_SPIRV_HASH, "shaderbinaries.h and shaderlayout.h were made from different SPIR-V, rebuild the shaders");
 
 struct QueueFamilyIndices
 {
@@ -43,21 +66,119 @@ struct SwapChainSupportDetails
     std::vector<VkPresentModeKHR> presentModes;
 };
 
-struct UniformBufferObject
+//Everything the render thread needs from one simulation step. Written once by
+//the update thread and read-only afterwards.
+struct FrameSnapshot
 {
-    glm::mat4 model;
     glm::mat4 view;
-    glm::mat4 proj;
+    //when the camera was sampled, the start of the input-to-present latency
+    std::chrono::steady_clock::time_point sampleTime;
+    //reused between snapshots so the update thread stops allocating once warm
+    std::vector<ObjectPushConstants> draws;
+    //cpu time the update stage spent producing this snapshot
+    double updateMs;
+};
+
+//Transient pool owned by one frame in flight. Reset whole once that frame has
+//finished on the GPU, its buffers are handed out again instead of reallocated.
+struct FrameCommandPool
+{
+    VkCommandPool pool;
+    std::vector<VkCommandBuffer> buffers;
+    //buffers handed out since the last reset
+    uint32_t used;
+};
+
+//what a cached command buffer baked in that has since changed
+enum CommandDirtyFlags : uint32_t
+{
+    COMMANDS_DIRTY_SCENE = 1,
+    COMMANDS_DIRTY_PIPELINE = 2,
+    COMMANDS_DIRTY_SWAPCHAIN = 4,
+    COMMANDS_DIRTY_ALL = 7
+};
+
+//a primary command buffer recorded once and resubmitted until something it baked in changes
+struct CachedCommands
+{
+    VkCommandBuffer commandBuffer;
+    uint32_t dirty;
+    //the dynamic uniform offset is baked into the descriptor bind
+    uint32_t uniformOffset;
+};
+
+//how far the cpu may run ahead of the gpu, and how deep the swapchain queue is
+struct FramePacing
+{
+    uint32_t framesInFlight;
+    //requested on top of the surface's minImageCount
+    uint32_t extraSwapchainImages;
 };
 
+const FramePacing LOW_LATENCY_PACING = {1, 0};
+const FramePacing BALANCED_PACING = {2, 1};
+const FramePacing THROUGHPUT_PACING = {3, 2};
+
 class VulkanApp
 {
     public:
+        void configure(int argc, char **argv)
+        {
+            for(int i = 1; i < argc; i++)
+            {
+                std::string arg = argv[i];
+
+                if(arg == "--low-latency") framePacing = LOW_LATENCY_PACING;
+                else if(arg == "--balanced") framePacing = BALANCED_PACING;
+                else if(arg == "--throughput") framePacing = THROUGHPUT_PACING;
+                else if(arg == "--frames-in-flight" && i + 1 < argc)
+                { framePacing.framesInFlight = std::max(1, std::stoi(argv[++i])); }
+                else if(arg == "--extra-swapchain-images" && i + 1 < argc)
+                { framePacing.extraSwapchainImages = std::max(0, std::stoi(argv[++i])); }
+                else if(arg == "--present-mode" && i + 1 < argc)
+                {
+                    if(!parsePresentMode(argv[++i], presentMode))
+                    { throw std::runtime_error("unknown present mode " + std::string(argv[i])); }
+                }
+                else if(arg == "--fps-cap" && i + 1 < argc)
+                { frameRateCap = std::max(0.0, std::stod(argv[++i])); }
+                else if(arg == "--record-threads" && i + 1 < argc)
+                { recordThreads = std::max(1, std::stoi(argv[++i])); }
+                else if(arg == "--benchmark-recording" && i + 1 < argc)
+                { recordingBenchmarkDraws = std::max(1, std::stoi(argv[++i])); }
+                else if(arg == "--cache-commands") cacheCommands = true;
+                else if(arg == "--no-late-latch") lateLatching = false;
+                else if(arg == "--dump-render-graph") dumpRenderGraph = true;
+                else if(arg == "--check-heap") checkHeapAllocations = true;
+                else if(arg == "--hot-reload") hotReload = true;
+                else if(arg == "--shader-dir" && i + 1 < argc) shaderDirectory = argv[++i];
+                else if(arg == "--static-state") staticPipelineState = true;
+                else if(arg == "--no-pipeline-libraries") pipelineLibraries = false;
+                else if(arg == "--pipeline-threads" && i + 1 < argc)
+                { pipelineThreads = std::max(1, std::stoi(argv[++i])); }
+                else if(arg == "--update-depth" && i + 1 < argc)
+                { updateDepth = std::clamp(std::stoi(argv[++i]), 0, 4); }
+                else
+                { throw std::runtime_error("unknown argument " + arg); }
+            }
+
+            requestedPacing = framePacing;
+            requestedPresentMode = presentMode;
+        }
+
         void run()
         {
             initWindow();
             initVulkan();
-            mainLoop();
+
+            if(recordingBenchmarkDraws > 0) benchmarkRecording();
+            else
+            {
+                startUpdateThread();
+                mainLoop();
+                stopUpdateThread();
+            }
+
             cleanup();
         }
         
@@ -74,37 +195,130 @@ class VulkanApp
         VkFormat swapChainImageFormat;
         VkExtent2D swapChainExtent;
         std::vector<VkImageView> swapChainImageViews;
-        std::vector<VkFramebuffer> swapChainFramebuffers;
-        VkRenderPass renderPass;
+        //rendering is dynamic, pipelines and secondaries only need the attachment formats
+        VkFormat depthFormat;
         VkDescriptorSetLayout descriptorSetLayout;
         VkPipelineLayout pipelineLayout;
-        VkPipeline graphicsPipeline;
+        VkShaderModule vertShaderModule;
+        VkShaderModule fragShaderModule;
+        //read .spv files from here instead of the ones embedded at build time
+        std::string shaderDirectory;
+        PipelineCache pipelineCache;
+        PipelineCompiler pipelineCompiler;
+        uint32_t pipelineThreads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+        //compiled up front, pipelines requested later draw with it until they are ready
+        uint32_t basePipeline;
+        //what the scene draws with, may still be compiling
+        uint32_t scenePipeline;
+        //what it was asked for with, the state the compiler leaves dynamic is set from this
+        GraphicsPipelineDesc sceneDesc;
+        //bakes cull, depth and blend into every pipeline as before, to compare pipeline counts
+        bool staticPipelineState = false;
+        //link pipelines from shared parts where the device supports it
+        bool pipelineLibraries = true;
+        bool doubleSided = false;
+        uint32_t sceneFeatures = PIPELINE_TEXTURED;
+        //recompiles shaders/*.vert and *.frag when they are saved
+        bool hotReload = false;
+        ShaderWatcher shaderWatcher;
+        uint32_t vertShaderSource;
+        uint32_t fragShaderSource;
+        std::vector<uint32_t> reloadedShaders;
+        std::chrono::steady_clock::time_point lastPipelineCacheSave;
+        //persistent pool, only cached command buffers which are re-recorded one at a time
         VkCommandPool commandPool;
         VkDescriptorPool descriptorPool;
-        std::vector<VkDescriptorSet> descriptorSets;
+        VkDescriptorSet descriptorSet;
 
         VkImage textureImage;
-        VkDeviceMemory textureImageMemory;
+        uint32_t textureImageAllocation;
         VkImageView textureImageView;
         VkSampler textureSampler;
 
+        TransientImagePool transientImages;
+        RenderGraph renderGraph;
+        uint32_t graphBackbuffer;
+        uint32_t graphDepth;
+        bool dumpRenderGraph = false;
+        //what the graph's scene pass records into, set before each execute
+        uint32_t recordImageIndex = 0;
+        bool recordParallel = false;
         VkImage depthImage;
-        VkDeviceMemory depthImageMemory;
         VkImageView depthImageView;
 
         VkBuffer vertexBuffer;
-        VkDeviceMemory vertexBufferMemory;
+        uint32_t vertexBufferAllocation;
         VkBuffer indexBuffer;
-        VkDeviceMemory indexBufferMemory;
-
-        std::vector<VkBuffer> uniformBuffers;
-        std::vector<VkDeviceMemory> uniformBuffersMemory;
-        std::vector<void*> uniformBuffersMapped;
-
-        std::vector<VkCommandBuffer> commandBuffers;
+        uint32_t indexBufferAllocation;
+
+        DeviceAllocator allocator;
+        Defragmenter defragmenter;
+        std::vector<DefragMove> defragMoves;
+        //everything destroyed while frames may still be using it goes through here, tagged with timeline values
+        DeletionQueue deletionQueue;
+
+        UniformRing uniformRing;
+        uint32_t frameUniformOffset = 0;
+        std::vector<glm::mat4> objectTransforms;
+
+        std::vector<FrameCommandPool> frameCommandPools;
+
+        //one-shot upload commands, recycled once their submit has been waited on
+        VkCommandPool uploadCommandPool;
+        std::vector<VkCommandBuffer> uploadCommandBuffers;
+        uint32_t uploadCommandsInUse = 0;
+
+        ParallelRecorder recorder;
+        uint32_t recordThreads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+        std::vector<VkCommandBuffer> secondaryBuffers;
+        //draw list the recording threads read from
+        const ObjectPushConstants *frameDraws = nullptr;
+        uint32_t frameDrawCount = 0;
+        //draws per record in benchmark mode, 0 runs the app normally
+        uint32_t recordingBenchmarkDraws = 0;
+
+        //snapshots the update thread may run ahead of the one being rendered, 0 updates inline
+        uint32_t updateDepth = 1;
+        SnapshotRing<FrameSnapshot> snapshots;
+        std::thread updateThread;
+        std::atomic<bool> updateRunning{false};
+        FrameSnapshot inlineSnapshot;
+        double updateStageMs = 0.0;
+        double renderStageMs = 0.0;
+
+        const std::chrono::high_resolution_clock::time_point sceneStartTime = 
+            std::chrono::high_resolution_clock::now();
+
+        //rewrite the camera in the mapped uniform data right before submit instead of trusting the snapshot
+        bool lateLatching = true;
+        void *frameUniformData = nullptr;
+        std::chrono::steady_clock::time_point cameraSampleTime;
+
+        bool presentWaitSupported = false;
+        bool dynamicBlendSupported = false;
+        bool pipelineLibrariesSupported = false;
+        PresentTimer presentTimer;
+        uint64_t nextPresentId = 0;
+
+        //replay command buffers recorded per (frame slot, swapchain image) instead of recording every frame
+        bool cacheCommands = false;
+        //indexed [frame slot * swapchain image count + image]
+        std::vector<CachedCommands> cachedCommands;
+        uint64_t cachedReplays = 0;
+        uint64_t cachedRecords = 0;
         std::vector<VkSemaphore> imageAvailableSemaphores;
         std::vector<VkSemaphore> renderFinishedSemaphores;
-        std::vector<VkFence> inFlightFences;
+        //one timeline for every submit, frames and uploads alike
+        VkSemaphore timeline;
+        //last value handed to a submit
+        uint64_t timelineValue = 0;
+        //value each frame slot has to reach before it can be reused
+        std::vector<uint64_t> frameTimelineValues;
+        std::vector<FrameArena> frameArenas;
+        uint32_t steadyFrames = 0;
+        //throws once a steady-state frame touches the heap, on any thread
+        bool checkHeapAllocations = false;
+        uint64_t frameNumber = 0;
         
         VkDebugUtilsMessengerEXT debugMessenger;
 
@@ -115,9 +329,42 @@ class VulkanApp
 
         const std::string MODEL_PATH = "models/viking_room.obj";
         const std::string TEXTURE_PATH = "textures/viking_room.png";
+        const std::string PIPELINE_CACHE_PATH = "pipeline.cache";
+        const std::chrono::seconds PIPELINE_CACHE_SAVE_INTERVAL = std::chrono::seconds(30);
+
+        FramePacing framePacing = BALANCED_PACING;
+        //picked up at the start of the next frame
+        FramePacing requestedPacing = BALANCED_PACING;
+
+        //preferred mode, the swapchain falls back when the surface lacks it
+        VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+        VkPresentModeKHR requestedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+        VkPresentModeKHR swapChainPresentMode;
+        const std::array<VkPresentModeKHR, 4> PRESENT_MODES = 
+        {
+            VK_PRESENT_MODE_MAILBOX_KHR,
+            VK_PRESENT_MODE_FIFO_KHR,
+            VK_PRESENT_MODE_FIFO_RELAXED_KHR,
+            VK_PRESENT_MODE_IMMEDIATE_KHR
+        };
 
-        const int MAX_FRAMES_IN_FLIGHT = 2;
+        FrameLimiter frameLimiter;
+        //frames per second, 0 is uncapped
+        double frameRateCap = 0.0;
+        const std::array<double, 5> FRAME_RATE_CAPS = {0.0, 30.0, 60.0, 120.0, 144.0};
+        std::chrono::steady_clock::time_point lastTimingReport;
+        const VkDeviceSize UNIFORM_RING_FRAME_SIZE = 256 * 1024;
         uint32_t currentFrame = 0;
+        //value the frame being built will signal
+        uint64_t frameTimelineValue = 0;
+
+        const VkDeviceSize MEMORY_BLOCK_SIZE = 64 * 1024 * 1024;
+        const VkDeviceSize DEFRAG_BYTES_PER_FRAME = 4 * 1024 * 1024;
+        const float DEFRAG_MAX_BLOCK_USAGE = 0.5f;
+
+        const size_t FRAME_ARENA_SIZE = 1024 * 1024;
+        //frames without resizes or defrag moves before heap allocations count as a bug
+        const uint32_t HEAP_CHECK_WARMUP_FRAMES = 16;
 
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
@@ -194,6 +441,7 @@ class VulkanApp
             window = glfwCreateWindow(800, 600, "VulkanApp", nullptr, nullptr);
             glfwSetWindowUserPointer(window, this);
             glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+            glfwSetKeyCallback(window, keyCallback);
         }
 
         static void framebufferResizeCallback(GLFWwindow* window, int width, int height)
@@ -202,6 +450,24 @@ class VulkanApp
             app -> frambufferResized = true;
         }
 
+        static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+        {
+            if(action != GLFW_PRESS) return;
+
+            VulkanApp* app = reinterpret_cast<VulkanApp*>(glfwGetWindowUserPointer(window));
+
+            if(key == GLFW_KEY_1) app -> requestedPacing = LOW_LATENCY_PACING;
+            else if(key == GLFW_KEY_2) app -> requestedPacing = BALANCED_PACING;
+            else if(key == GLFW_KEY_3) app -> requestedPacing = THROUGHPUT_PACING;
+            else if(key == GLFW_KEY_P) app -> cyclePresentMode();
+            else if(key == GLFW_KEY_L) app -> cycleFrameRateCap();
+            else if(key == GLFW_KEY_C) app -> cacheCommands = !app -> cacheCommands;
+            else if(key == GLFW_KEY_D) app -> toggleDoubleSided();
+            else if(key == GLFW_KEY_A) app -> toggleSceneFeature(PIPELINE_ALPHA_TEST);
+            else if(key == GLFW_KEY_T) app -> toggleSceneFeature(PIPELINE_TEXTURED);
+            else if(key == GLFW_KEY_V) app -> toggleSceneFeature(PIPELINE_VERTEX_COLOR);
+        }
+
         //-----------------------$Device----------------------//
         //----------------------------------------------------//
         //----------------------------------------------------//
@@ -248,6 +514,108 @@ class VulkanApp
             return requiredExtensions.empty();
         }
 
+        //optional, lets blend state be set on the command buffer too
+        bool checkDynamicBlendSupport(VkPhysicalDevice device)
+        {
+            uint32_t extensionCount;
+            vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+            std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+            vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+            bool extensionFound = false;
+            for(const auto& extension : availableExtensions)
+            {
+                if(strcmp(extension.extensionName, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME) == 0)
+                { extensionFound = true; }
+            }
+
+            if(!extensionFound) return false;
+
+            VkPhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicState3Features{};
+            dynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+            VkPhysicalDeviceFeatures2 features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &dynamicState3Features;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
+
+            return dynamicState3Features.extendedDynamicState3ColorBlendEnable
+                && dynamicState3Features.extendedDynamicState3ColorBlendEquation;
+        }
+
+        //optional, only worth it where linking the parts is fast
+        bool checkPipelineLibrarySupport(VkPhysicalDevice device)
+        {
+            uint32_t extensionCount;
+            vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+            std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+            vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+            std::set<std::string> requiredExtensions = {VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+                VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME};
+
+            for(const auto& extension : availableExtensions)
+            {
+                requiredExtensions.erase(extension.extensionName);
+            }
+
+            if(!requiredExtensions.empty()) return false;
+
+            VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures{};
+            libraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+            VkPhysicalDeviceFeatures2 features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &libraryFeatures;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
+
+            VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties{};
+            libraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+
+            VkPhysicalDeviceProperties2 properties2{};
+            properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties2.pNext = &libraryProperties;
+            vkGetPhysicalDeviceProperties2(device, &properties2);
+
+            return libraryFeatures.graphicsPipelineLibrary && libraryProperties.graphicsPipelineLibraryFastLinking;
+        }
+
+        //optional, only used to measure when frames actually reach the screen
+        bool checkPresentWaitSupport(VkPhysicalDevice device)
+        {
+            uint32_t extensionCount;
+            vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+            std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+            vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data()); 
+
+            std::set<std::string> requiredExtensions = {VK_KHR_PRESENT_ID_EXTENSION_NAME, 
+                VK_KHR_PRESENT_WAIT_EXTENSION_NAME};
+
+            for(const auto& extension : availableExtensions)
+            {
+                requiredExtensions.erase(extension.extensionName);
+            }
+
+            if(!requiredExtensions.empty()) return false;
+
+            VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+            presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+            VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+            presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+            presentIdFeatures.pNext = &presentWaitFeatures;
+
+            VkPhysicalDeviceFeatures2 features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &presentIdFeatures;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
+
+            return presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+        }
+
         void createLogicalDevice()
         {
             QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
@@ -269,9 +637,64 @@ class VulkanApp
             VkPhysicalDeviceFeatures deviceFeatures{};
             deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+            VkPhysicalDeviceVulkan12Features vulkan12Features{};
+            vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            vulkan12Features.timelineSemaphore = VK_TRUE;
+
+            VkPhysicalDeviceVulkan13Features vulkan13Features{};
+            vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+            vulkan13Features.synchronization2 = VK_TRUE;
+            vulkan13Features.dynamicRendering = VK_TRUE;
+            vulkan12Features.pNext = &vulkan13Features;
+
+            std::vector<const char*> enabledExtensions = deviceExtensions;
+
+            VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+            presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+            presentWaitFeatures.presentWait = VK_TRUE;
+
+            VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+            presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+            presentIdFeatures.presentId = VK_TRUE;
+            presentIdFeatures.pNext = &presentWaitFeatures;
+
+            presentWaitSupported = checkPresentWaitSupport(physicalDevice);
+            if(presentWaitSupported)
+            {
+                enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                vulkan13Features.pNext = &presentIdFeatures;
+            }
+
+            VkPhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicState3Features{};
+            dynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+            dynamicState3Features.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+            dynamicState3Features.extendedDynamicState3ColorBlendEquation = VK_TRUE;
+
+            dynamicBlendSupported = checkDynamicBlendSupport(physicalDevice);
+            if(dynamicBlendSupported)
+            {
+                enabledExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+                dynamicState3Features.pNext = vulkan13Features.pNext;
+                vulkan13Features.pNext = &dynamicState3Features;
+            }
+
+            VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures{};
+            libraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+            libraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+
+            pipelineLibrariesSupported = checkPipelineLibrarySupport(physicalDevice);
+            if(pipelineLibrariesSupported)
+            {
+                enabledExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+                enabledExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+                libraryFeatures.pNext = vulkan13Features.pNext;
+                vulkan13Features.pNext = &libraryFeatures;
+            }
+
             VkDeviceCreateInfo createInfo{};
             populateDeviceCreateInfo(createInfo, queueCreateInfos, deviceFeatures,
-                deviceExtensions, enableValidationLayers, validationLayers);
+                enabledExtensions, enableValidationLayers, validationLayers, &vulkan12Features);
 
             std::cout << "Creating logical device..." << std::endl;
             if(vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS)
@@ -299,8 +722,30 @@ class VulkanApp
             VkPhysicalDeviceFeatures supportedFeatures;
             vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device, &properties);
+
+            bool featuresSupported = false;
+            if(properties.apiVersion >= VK_API_VERSION_1_3)
+            {
+                VkPhysicalDeviceVulkan13Features vulkan13Features{};
+                vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+                VkPhysicalDeviceVulkan12Features vulkan12Features{};
+                vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+                vulkan12Features.pNext = &vulkan13Features;
+
+                VkPhysicalDeviceFeatures2 features2{};
+                features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+                features2.pNext = &vulkan12Features;
+                vkGetPhysicalDeviceFeatures2(device, &features2);
+
+                featuresSupported = vulkan12Features.timelineSemaphore && vulkan13Features.synchronization2
+                    && vulkan13Features.dynamicRendering;
+            }
+
             return indices.isComplete() && extensionsSupported && swapChainAdequate
-                && supportedFeatures.samplerAnisotropy;
+                && supportedFeatures.samplerAnisotropy && featuresSupported;
         }
 
         QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device)
@@ -364,7 +809,7 @@ class VulkanApp
             return details;
         }
 
-        void createSwapChain()
+        void createSwapChain(VkSwapchainKHR oldSwapChain)
         {
             SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
 
@@ -372,7 +817,7 @@ class VulkanApp
             glfwGetFramebufferSize(window, &width, &height);
 
 
-            uint32_t imageCount = swapChainSupport.capabilites.minImageCount + 1;
+            uint32_t imageCount = swapChainSupport.capabilites.minImageCount + framePacing.extraSwapchainImages;
 
             if(swapChainSupport.capabilites.maxImageCount > 0 
             && imageCount > swapChainSupport.capabilites.maxImageCount) 
@@ -391,12 +836,15 @@ class VulkanApp
             populateSwapchainCreateInfo(createInfo, 
                 swapChainSupport.formats, swapChainSupport.presentModes, swapChainSupport.capabilites,
                 width, height, imageCount, surface,
-                queueFamilyIndices, format, extent);
+                queueFamilyIndices, presentMode, oldSwapChain, format, extent, swapChainPresentMode);
 
+            //the old swapchain may still be waited on by the present timer
+            std::unique_lock<std::mutex> swapchainLock(presentTimer.getSwapchainMutex());
             if(vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS)
             {
                 throw std::runtime_error("failed to create swapchain");
             }
+            swapchainLock.unlock();
 
             swapChainImageFormat = format;
             swapChainExtent = extent;
@@ -416,26 +864,33 @@ class VulkanApp
                 glfwWaitEvents();
             }
 
-            vkDeviceWaitIdle(device);
+            //frames keep flowing, the old objects are destroyed once no submit can reach them
+            //presentation may still read old images after the last frame using them has finished,
+            //so they wait another round of frames in flight
+            uint64_t retireValue = timelineValue + framePacing.framesInFlight;
+            VkSwapchainKHR oldSwapChain = swapChain;
 
-            cleanupSwapChain();
+            for(VkImageView imageView : swapChainImageViews)
+            { deletionQueue.destroyImageView(imageView, retireValue); }
+
+            transientImages.release(deletionQueue, retireValue);
 
-            createSwapChain();
+            createSwapChain(oldSwapChain);
             createImageViews();
-            createDepthResources();
-            createFramebuffers();
+            buildRenderGraph();
+
+            presentTimer.retireSwapchain(oldSwapChain);
+            deletionQueue.destroySwapchain(oldSwapChain, retireValue);
+
+            if(cachedCommands.size() != framePacing.framesInFlight * swapChainImages.size())
+            { allocateCachedCommands(); }
+            else
+            { markCommandsDirty(COMMANDS_DIRTY_SWAPCHAIN); }
         }
 
         void cleanupSwapChain()
         {
-            vkDestroyImageView(device, depthImageView, nullptr);
-            vkDestroyImage(device, depthImage, nullptr);
-            vkFreeMemory(device, depthImageMemory, nullptr);
-
-            for(size_t i = 0; i < swapChainFramebuffers.size(); i++)
-            {
-                vkDestroyFramebuffer(device, swapChainFramebuffers[i], nullptr);
-            }
+            transientImages.destroy(device);
 
             for (size_t i = 0; i < swapChainImageViews.size(); i++)
             {
@@ -464,130 +919,86 @@ class VulkanApp
         //------------------------------------------------------//
         //------------------------------------------------------//
 
-        void createRenderPass()
+        //core 1.3 covers cull and depth, blend needs extended dynamic state 3
+        uint32_t getPipelineDynamicState()
         {
-            VkAttachmentDescription colorAttachment{};
-            populateColorAttachment(colorAttachment, swapChainImageFormat);
-
-            VkAttachmentReference colorAttachmentRef{};
-            populateColorAttachmentRef(colorAttachmentRef);
-
-            VkAttachmentDescription depthAttachment{};
-            populateDepthAttachment(depthAttachment, findDepthFormat());
-
-            VkAttachmentReference depthAttachmentRef{};
-            populateDepthAttachmentRef(depthAttachmentRef);
+            if(staticPipelineState) return 0;
 
-            VkSubpassDescription subpass{};
-            populateSubpass(subpass, colorAttachmentRef, depthAttachmentRef);
-
-            VkSubpassDependency dependency{};
-            populateSubpassDependency(dependency);
-
-            std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
-
-            VkRenderPassCreateInfo renderPassInfo{};
-            populateRenderPassCreateInfo(renderPassInfo, attachments, subpass, dependency);
-
-            if(vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
-            { throw std::runtime_error("failed to create render pass"); }
+            return PIPELINE_DYNAMIC_RASTER | (dynamicBlendSupported ? PIPELINE_DYNAMIC_BLEND : 0);
         }
 
         void createGraphicsPipeline()
         {
-            std::vector<char> vertShaderCode = readFile("shaders/vert.spv");
-            std::vector<char> fragShaderCode = readFile("shaders/frag.spv");
-
-            VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-            VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
-
-            VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-            populateVertShaderStageCreateInfo(vertShaderStageInfo, vertShaderModule);
-
-            VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-            populateFragShaderStageCreateInfo(fragShaderStageInfo, fragShaderModule);
-
-            VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+            //kept for the pipelines requested later
+            vertShaderModule = loadShaderModule("vert.spv");
+            fragShaderModule = loadShaderModule("frag.spv");
 
-            std::vector<VkDynamicState> dynamicStates = 
-            {
-                VK_DYNAMIC_STATE_VIEWPORT,
-                VK_DYNAMIC_STATE_SCISSOR
-            };
-
-            VkPipelineDynamicStateCreateInfo dynamicState{};
-            populatePipelineDynamicStateCreateInfo(dynamicState, dynamicStates);
-
-            auto bindingDescription = Vertex::getBindingDescription();
-            auto attributeDescriptions = Vertex::getAttributeDescriptions(); 
-            VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-            populatePipelineVertexInputStateCreateInfo(vertexInputInfo,
-                bindingDescription, attributeDescriptions);
-
-            VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-            populatePipelineInputAssemblyStateCreateInfo(inputAssembly);
+            VkPushConstantRange pushConstantRange{};
+            populatePushConstantRange(pushConstantRange, SHADER_PUSH_CONSTANT_STAGES, SHADER_PUSH_CONSTANT_SIZE);
 
-            VkViewport viewport{};
-            populateViewport(viewport, swapChainExtent);
-
-            VkRect2D scissor{};
-            populateScissor(scissor, swapChainExtent);
+            VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+            populatePipelineLayoutCreateInfo(pipelineLayoutInfo, descriptorSetLayout, pushConstantRange);
 
-            VkPipelineViewportStateCreateInfo viewportState{};
-            populatePipelineViewportStateCreateInfo(viewportState, viewport, scissor);
+            if(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+            { throw std::runtime_error("failed to create pipeline layout"); }
 
-            VkPipelineRasterizationStateCreateInfo rasterizer{};
-            populatePipelineRasterizationStateCreateInfo(rasterizer);
+            sceneDesc = getDefaultPipelineDesc(vertShaderModule, fragShaderModule,
+                pipelineLayout, swapChainImageFormat, depthFormat);
+            basePipeline = pipelineCompiler.compile(sceneDesc);
+            scenePipeline = basePipeline;
 
-            VkPipelineMultisampleStateCreateInfo multisampling{};
-            populatePipelineMultisampleStateCreateInfo(multisampling);
+            markCommandsDirty(COMMANDS_DIRTY_PIPELINE);
+        }
 
-            VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-            populatePipelineColorBlendAttachmentState(colorBlendAttachment);
+        //a variant is compiled in the background the first time, the scene keeps drawing meanwhile
+        //with dynamic state only a feature change needs another pipeline
+        void selectScenePipeline()
+        {
+            sceneDesc = getDefaultPipelineDesc(vertShaderModule, fragShaderModule,
+                pipelineLayout, swapChainImageFormat, depthFormat);
+            sceneDesc.cullMode = doubleSided ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
+            sceneDesc.features = sceneFeatures;
 
-            VkPipelineColorBlendStateCreateInfo colorBlending{};
-            populatePipelineColorBlendStateCreateInfo(colorBlending, colorBlendAttachment);
+            scenePipeline = pipelineCompiler.getVariant(sceneDesc, basePipeline);
+            markCommandsDirty(COMMANDS_DIRTY_PIPELINE);
+        }
 
-            VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-            populatePipelineLayoutCreateInfo(pipelineLayoutInfo, descriptorSetLayout);
+        void toggleDoubleSided()
+        {
+            doubleSided = !doubleSided;
+            selectScenePipeline();
+        }
 
-            VkPipelineDepthStencilStateCreateInfo depthStencil{};
-            populatePipelineDepthStencilStateCreateInfo(depthStencil);
+        void toggleSceneFeature(uint32_t feature)
+        {
+            sceneFeatures ^= feature;
+            selectScenePipeline();
+        }
 
-            if(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
-            { throw std::runtime_error("failed to create pipeline layout"); }
+        //straight from the executable's static data unless shaderDirectory is set
+        VkShaderModule loadShaderModule(const char *name)
+        {
+            if(!shaderDirectory.empty())
+            { return createShaderModule(readFile(shaderDirectory + "/" + name)); }
 
-            VkGraphicsPipelineCreateInfo pipelineInfo{};
-            pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-            pipelineInfo.stageCount = 2;
-            pipelineInfo.pStages = shaderStages;
-            pipelineInfo.pVertexInputState = &vertexInputInfo;
-            pipelineInfo.pInputAssemblyState = &inputAssembly;
-            pipelineInfo.pViewportState = &viewportState;
-            pipelineInfo.pRasterizationState = &rasterizer;
-            pipelineInfo.pMultisampleState = &multisampling;
-            pipelineInfo.pDepthStencilState = &depthStencil;
-            pipelineInfo.pColorBlendState = &colorBlending;
-            pipelineInfo.pDynamicState = &dynamicState;
-            pipelineInfo.layout = pipelineLayout;
-            pipelineInfo.renderPass = renderPass;
-            pipelineInfo.subpass = 0;
-            pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-            pipelineInfo.basePipelineIndex = -1;
-
-            if(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
-            { throw std::runtime_error("failed to create graphics pipeline"); }
+            const EmbeddedShader *shader = findEmbeddedShader(name);
+            if(shader == nullptr)
+            { throw std::runtime_error("no embedded shader " + std::string(name)); }
 
-            vkDestroyShaderModule(device, vertShaderModule, nullptr);
-            vkDestroyShaderModule(device, fragShaderModule, nullptr);
+            return createShaderModule(shader->code, shader->size);
         }
 
         VkShaderModule createShaderModule(const std::vector<char>& code)
+        {
+            return createShaderModule(reinterpret_cast<const uint32_t*>(code.data()), code.size());
+        }
+
+        VkShaderModule createShaderModule(const uint32_t *code, size_t codeSize)
         {
             VkShaderModuleCreateInfo createInfo{};
             createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-            createInfo.codeSize = code.size();
-            createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+            createInfo.codeSize = codeSize;
+            createInfo.pCode = code;
 
             VkShaderModule shaderModule;
             if(vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
@@ -596,30 +1007,41 @@ class VulkanApp
             return shaderModule;
         }
 
-        //-----------------------$Framebuffers----------------------//
-        //----------------------------------------------------------//
-        //----------------------------------------------------------//
+        //hot reload is a development aid, without shaderc or the sources it is turned off instead of failing
+        void watchShaders()
+        {
+            try
+            {
+                shaderWatcher.create();
+                vertShaderSource = shaderWatcher.watch("shaders/shader.vert", VK_SHADER_STAGE_VERTEX_BIT);
+                fragShaderSource = shaderWatcher.watch("shaders/shader.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
+            }
+            catch(const std::exception& e)
+            {
+                std::cout << "hot reload disabled: " << e.what() << std::endl;
+                shaderWatcher.destroy();
+                hotReload = false;
+            }
+        }
 
-        void createFramebuffers()
+        //runs at the frame boundary, the rebuilt pipelines are swapped in by a later poll
+        void reloadShaders()
         {
-            swapChainFramebuffers.resize(swapChainImageViews.size());
+            if(!hotReload) return;
 
-            for(size_t i = 0; i < swapChainImageViews.size(); i++)
-            {
+            shaderWatcher.poll(reloadedShaders);
 
-                std::array<VkImageView, 2> attachments = {swapChainImageViews[i], depthImageView};
+            for(uint32_t shader : reloadedShaders)
+            {
+                const std::vector<uint32_t> &spirv = shaderWatcher.getSpirv(shader);
+                VkShaderModule reloaded = createShaderModule(spirv.data(), spirv.size() * sizeof(uint32_t));
 
-                VkFramebufferCreateInfo framebufferInfo{};
-                framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-                framebufferInfo.renderPass = renderPass;
-                framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-                framebufferInfo.pAttachments = attachments.data();
-                framebufferInfo.width = swapChainExtent.width;
-                framebufferInfo.height = swapChainExtent.height;
-                framebufferInfo.layers = 1;
+                VkShaderModule &current = shader == vertShaderSource ? vertShaderModule : fragShaderModule;
+                uint32_t rebuilt = pipelineCompiler.replaceShader(current, reloaded);
+                current = reloaded;
 
-                if(vkCreateFramebuffer(device, &framebufferInfo, nullptr, &swapChainFramebuffers[i]) != VK_SUCCESS)
-                { throw std::runtime_error("failed to create framebuffer"); }
+                std::cout << "shader reload: " << shaderWatcher.getPath(shader) << ", rebuilding " 
+                    << rebuilt << " pipelines" << std::endl;
             }
         }
 
@@ -638,9 +1060,15 @@ class VulkanApp
 
             if(vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
             { throw std::runtime_error("failed to create command pool"); }
+
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+            if(vkCreateCommandPool(device, &poolInfo, nullptr, &uploadCommandPool) != VK_SUCCESS)
+            { throw std::runtime_error("failed to create command pool"); }
         }
 
-        void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+        void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex,
+            const ArenaVector<ObjectPushConstants> &draws, bool parallel)
         {
             VkCommandBufferBeginInfo beginInfo{};
             beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -650,21 +1078,87 @@ class VulkanApp
             if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
             { throw std::runtime_error("failed to begin recording command buffer"); }
 
-            VkRenderPassBeginInfo renderPassInfo{};
-            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderPassInfo.renderPass = renderPass;
-            renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
-            renderPassInfo.renderArea.offset = {0, 0};
-            renderPassInfo.renderArea.extent = swapChainExtent;
+            //cached buffers get moves from the per-frame prologue instead
+            if(parallel)
+            { defragmenter.recordMoves(commandBuffer, frameTimelineValue); }
+
+            frameDraws = draws.data();
+            frameDrawCount = static_cast<uint32_t>(draws.size());
+            recordImageIndex = imageIndex;
+            recordParallel = parallel;
+
+            renderGraph.setImportedImage(graphBackbuffer, swapChainImages[imageIndex], swapChainImageViews[imageIndex]);
+            renderGraph.execute(commandBuffer);
+
+            if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+            { throw std::runtime_error("failed to record command buffer"); }
+        }
+
+        static void recordScenePass(VkCommandBuffer commandBuffer, void *context)
+        {
+            reinterpret_cast<VulkanApp*>(context) -> recordScene(commandBuffer);
+        }
+
+        void recordScene(VkCommandBuffer commandBuffer)
+        {
             std::array<VkClearValue, 2> clearValues{};
             clearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
             clearValues[1].depthStencil = {1.0f, 0};
-            renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-            renderPassInfo.pClearValues = clearValues.data();
 
-            vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            //layouts are the ones the render graph transitioned the images to for this pass
+            VkRenderingAttachmentInfo colorAttachment{};
+            populateRenderingAttachmentInfo(colorAttachment, renderGraph.getImageView(graphBackbuffer),
+                getImageUsageState(GRAPH_COLOR_ATTACHMENT).layout, VK_ATTACHMENT_STORE_OP_STORE, clearValues[0]);
 
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+            //nothing reads depth after the pass
+            VkRenderingAttachmentInfo depthAttachment{};
+            populateRenderingAttachmentInfo(depthAttachment, renderGraph.getImageView(graphDepth),
+                getImageUsageState(GRAPH_DEPTH_ATTACHMENT).layout, VK_ATTACHMENT_STORE_OP_DONT_CARE, clearValues[1]);
+
+            if(recordParallel)
+            {
+                VkRenderingInfo renderingInfo{};
+                populateRenderingInfo(renderingInfo, swapChainExtent, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT,
+                    colorAttachment, depthAttachment);
+                vkCmdBeginRendering(commandBuffer, &renderingInfo);
+
+                VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{};
+                populateCommandBufferInheritanceRenderingInfo(inheritanceRenderingInfo, swapChainImageFormat, depthFormat);
+
+                VkCommandBufferInheritanceInfo inheritanceInfo{};
+                populateCommandBufferInheritanceInfo(inheritanceInfo, inheritanceRenderingInfo);
+
+                uint32_t secondaryCount = recorder.record(currentFrame, inheritanceInfo, frameDrawCount, 
+                    recordDrawSlice, this, secondaryBuffers.data());
+
+                vkCmdExecuteCommands(commandBuffer, secondaryCount, secondaryBuffers.data());
+            }
+            else
+            {
+                //cached buffers outlive the recorder's per-frame pools, so they record inline
+                VkRenderingInfo renderingInfo{};
+                populateRenderingInfo(renderingInfo, swapChainExtent, 0, colorAttachment, depthAttachment);
+                vkCmdBeginRendering(commandBuffer, &renderingInfo);
+                recordDraws(commandBuffer, 0, frameDrawCount);
+            }
+
+            vkCmdEndRendering(commandBuffer);
+        }
+
+        static void recordDrawSlice(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count, void *context)
+        {
+            reinterpret_cast<VulkanApp*>(context) -> recordDraws(commandBuffer, first, count);
+        }
+
+        //runs on the recording threads, state is not inherited so every slice binds its own
+        void recordDraws(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)
+        {
+            //still compiling and nothing to fall back to
+            VkPipeline pipeline = pipelineCompiler.resolve(scenePipeline);
+            if(pipeline == VK_NULL_HANDLE) return;
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            pipelineCompiler.recordDynamicState(commandBuffer, sceneDesc);
 
             VkViewport viewport{};
             viewport.x = 0.0f;
@@ -687,40 +1181,224 @@ class VulkanApp
             vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
             vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+                pipelineLayout, 0, 1, &descriptorSet, 1, &frameUniformOffset);
+
+            for(uint32_t i = first; i < first + count; i++)
+            {
+                vkCmdPushConstants(commandBuffer, pipelineLayout, SHADER_PUSH_CONSTANT_STAGES,
+                    0, sizeof(ObjectPushConstants), &frameDraws[i]);
+
+                vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+            }
+        }
+
+        void createRecorder()
+        {
+            QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+
+            recorder.create(device, queueFamilyIndices.graphicsFamily.value(), 
+                recordThreads, framePacing.framesInFlight);
+            secondaryBuffers.resize(recorder.getThreadCount());
+        }
+
+        //records the same draw list with 1 to recordThreads threads and prints the time per record
+        void benchmarkRecording()
+        {
+            const uint32_t WARMUP_ITERATIONS = 5;
+            const uint32_t ITERATIONS = 50;
+
+            std::vector<ObjectPushConstants> draws(recordingBenchmarkDraws);
+            for(uint32_t i = 0; i < recordingBenchmarkDraws; i++)
+            {
+                draws[i].model = glm::mat4(1.0f);
+                draws[i].objectIndex = i;
+            }
+
+            frameDraws = draws.data();
+            frameDrawCount = recordingBenchmarkDraws;
+
+            VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{};
+            populateCommandBufferInheritanceRenderingInfo(inheritanceRenderingInfo, swapChainImageFormat, depthFormat);
+
+            VkCommandBufferInheritanceInfo inheritanceInfo{};
+            populateCommandBufferInheritanceInfo(inheritanceInfo, inheritanceRenderingInfo);
+
+            std::cout << "recording " << recordingBenchmarkDraws << " draws" << std::endl;
+
+            double singleThreadMs = 0.0;
+            for(uint32_t threads = 1; threads <= recorder.getThreadCount(); threads++)
+            {
+                recorder.setActiveThreadCount(threads);
+
+                //nothing is submitted, so frame slot 0 can be re-recorded straight away
+                for(uint32_t i = 0; i < WARMUP_ITERATIONS; i++)
+                { recorder.record(0, inheritanceInfo, frameDrawCount, recordDrawSlice, this, secondaryBuffers.data()); }
+
+                auto start = std::chrono::steady_clock::now();
+                for(uint32_t i = 0; i < ITERATIONS; i++)
+                { recorder.record(0, inheritanceInfo, frameDrawCount, recordDrawSlice, this, secondaryBuffers.data()); }
+                auto end = std::chrono::steady_clock::now();
+
+                double ms = std::chrono::duration<double, std::milli>(end - start).count() / ITERATIONS;
+                if(threads == 1) singleThreadMs = ms;
+
+                std::cout << threads << " threads: " << ms << " ms per record, " 
+                    << singleThreadMs / ms << "x" << std::endl;
+            }
+
+            recorder.setActiveThreadCount(recordThreads);
+            frameDraws = nullptr;
+            frameDrawCount = 0;
+        }
+
+        void allocateCachedCommands()
+        {
+            //old buffers may still be pending on the gpu
+            for(const CachedCommands &cached : cachedCommands)
+            { deletionQueue.freeCommandBuffer(commandPool, cached.commandBuffer, timelineValue); }
+
+            cachedCommands.resize(framePacing.framesInFlight * swapChainImages.size());
+
+            for(CachedCommands &cached : cachedCommands)
+            {
+                VkCommandBufferAllocateInfo allocInfo{};
+                allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                allocInfo.commandPool = commandPool;
+                allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                allocInfo.commandBufferCount = 1;
+
+                if(vkAllocateCommandBuffers(device, &allocInfo, &cached.commandBuffer) != VK_SUCCESS)
+                { throw std::runtime_error("failed to allocate cached command buffer"); }
+
+                cached.dirty = COMMANDS_DIRTY_ALL;
+                cached.uniformOffset = 0;
+            }
+        }
+
+        void markCommandsDirty(uint32_t flags)
+        {
+            for(CachedCommands &cached : cachedCommands)
+            { cached.dirty |= flags; }
+        }
+
+        //returns the buffer to submit for this slot and image, recording it only when something changed
+        VkCommandBuffer getCachedCommands(uint32_t imageIndex, const ArenaVector<ObjectPushConstants> &draws)
+        {
+            CachedCommands &cached = cachedCommands[currentFrame * swapChainImages.size() + imageIndex];
+
+            if(cached.dirty == 0 && cached.uniformOffset == frameUniformOffset)
+            {
+                cachedReplays++;
+                return cached.commandBuffer;
+            }
+
+            //the slot's previous submit has finished, so the buffer is no longer pending
+            vkResetCommandBuffer(cached.commandBuffer, 0);
+            recordCommandBuffer(cached.commandBuffer, imageIndex, draws, false);
+
+            cached.dirty = 0;
+            cached.uniformOffset = frameUniformOffset;
+            cachedRecords++;
+
+            return cached.commandBuffer;
+        }
+
+        //work that has to be recorded every frame even when the scene pass is replayed
+        void recordPrologue(VkCommandBuffer commandBuffer)
+        {
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+            if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+            { throw std::runtime_error("failed to begin recording command buffer"); }
 
-            vkCmdEndRenderPass(commandBuffer);
+            defragmenter.recordMoves(commandBuffer, frameTimelineValue);
 
             if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
             { throw std::runtime_error("failed to record command buffer"); }
         }
 
-        void createCommandBuffers()
+        void createFrameCommandPools()
+        {
+            QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+
+            frameCommandPools.resize(framePacing.framesInFlight);
+
+            for(FrameCommandPool &framePool : frameCommandPools)
+            {
+                VkCommandPoolCreateInfo poolInfo{};
+                poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+                poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+                poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+
+                if(vkCreateCommandPool(device, &poolInfo, nullptr, &framePool.pool) != VK_SUCCESS)
+                { throw std::runtime_error("failed to create command pool"); }
+
+                framePool.buffers.clear();
+                framePool.used = 0;
+            }
+        }
+
+        void destroyFrameCommandPools()
+        {
+            //destroying a pool frees its buffers
+            for(FrameCommandPool &framePool : frameCommandPools)
+            { vkDestroyCommandPool(device, framePool.pool, nullptr); }
+
+            frameCommandPools.clear();
+        }
+
+        //the slot's previous submit must have completed
+        void resetFrameCommandPool(uint32_t frameIndex)
+        {
+            FrameCommandPool &framePool = frameCommandPools[frameIndex];
+
+            vkResetCommandPool(device, framePool.pool, 0);
+            framePool.used = 0;
+        }
+
+        //hands out a primary buffer from the current frame's pool, allocating only the first time
+        VkCommandBuffer acquireFrameCommandBuffer()
         {
-            commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+            FrameCommandPool &framePool = frameCommandPools[currentFrame];
+
+            if(framePool.used == framePool.buffers.size())
+            {
+                VkCommandBufferAllocateInfo allocInfo{};
+                allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                allocInfo.commandPool = framePool.pool;
+                allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                allocInfo.commandBufferCount = 1;
+
+                VkCommandBuffer commandBuffer;
+                if(vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+                { throw std::runtime_error("failed to allocate command buffers"); }
 
-            VkCommandBufferAllocateInfo allocInfo{};
-            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            allocInfo.commandPool = commandPool;
-            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            allocInfo.commandBufferCount = (uint32_t)commandBuffers.size();
+                framePool.buffers.push_back(commandBuffer);
+            }
 
-            if(vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS)
-            { throw std::runtime_error("failed to allocate command buffers"); }
+            return framePool.buffers[framePool.used++];
         }
 
         VkCommandBuffer beginSingleTimeCommands()
         {
-            VkCommandBufferAllocateInfo allocInfo{};
-            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            allocInfo.commandPool = commandPool;
-            allocInfo.commandBufferCount = 1;
+            if(uploadCommandsInUse == uploadCommandBuffers.size())
+            {
+                VkCommandBufferAllocateInfo allocInfo{};
+                allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                allocInfo.commandPool = uploadCommandPool;
+                allocInfo.commandBufferCount = 1;
+
+                VkCommandBuffer commandBuffer;
+                if(vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+                { throw std::runtime_error("failed to allocate command buffers"); }
+
+                uploadCommandBuffers.push_back(commandBuffer);
+            }
 
-            VkCommandBuffer commandBuffer;
-            vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+            VkCommandBuffer commandBuffer = uploadCommandBuffers[uploadCommandsInUse++];
 
             VkCommandBufferBeginInfo beginInfo{};
             beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -735,37 +1413,190 @@ class VulkanApp
         {
             vkEndCommandBuffer(commandBuffer);
 
+            uint64_t signalValue = ++timelineValue;
+
+            VkTimelineSemaphoreSubmitInfo timelineInfo{};
+            populateTimelineSemaphoreSubmitInfo(timelineInfo, 0, nullptr, 1, &signalValue);
+
             VkSubmitInfo submitInfo{};
             submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.pNext = &timelineInfo;
             submitInfo.commandBufferCount = 1;
             submitInfo.pCommandBuffers = &commandBuffer;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &timeline;
 
             vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-            vkQueueWaitIdle(graphicsQueue);
+            waitForTimeline(signalValue);
 
-            vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+            //once nothing is outstanding the whole pool goes back in one call
+            if(--uploadCommandsInUse == 0)
+            { vkResetCommandPool(device, uploadCommandPool, 0); }
+        }
+
+        void createTimeline()
+        {
+            VkSemaphoreTypeCreateInfo typeInfo{};
+            populateTimelineSemaphoreTypeCreateInfo(typeInfo, timelineValue);
+
+            VkSemaphoreCreateInfo semaphoreInfo{};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            semaphoreInfo.pNext = &typeInfo;
+
+            if(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timeline) != VK_SUCCESS)
+            { throw std::runtime_error("failed to create timeline semaphore"); }
+        }
+
+        void waitForTimeline(uint64_t value)
+        {
+            VkSemaphoreWaitInfo waitInfo{};
+            populateSemaphoreWaitInfo(waitInfo, timeline, value);
+
+            if(vkWaitSemaphores(device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+            { throw std::runtime_error("failed to wait for timeline semaphore"); }
+        }
+
+        uint64_t getCompletedTimelineValue()
+        {
+            uint64_t value;
+            vkGetSemaphoreCounterValue(device, timeline, &value);
+
+            return value;
         }
 
         void createSyncObjects()
         {
-            imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-            renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-            inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+            //acquire and present only take binary semaphores, everything else goes through the timeline
+            imageAvailableSemaphores.resize(framePacing.framesInFlight);
+            renderFinishedSemaphores.resize(framePacing.framesInFlight);
+            frameTimelineValues.assign(framePacing.framesInFlight, timelineValue);
+            frameArenas.resize(framePacing.framesInFlight);
 
             VkSemaphoreCreateInfo semaphoreInfo{};
             semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-            VkFenceCreateInfo fenceInfo{};
-            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-            for(size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++){
+            for(size_t i = 0; i < framePacing.framesInFlight; i++){
                 if(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS
-                || vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS
-                || vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+                || vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS)
                 { throw std::runtime_error("error creating semaphores"); }
+
+                frameArenas[i].create(FRAME_ARENA_SIZE);
             }
         }
 
+        void cleanupSyncObjects()
+        {
+            for(size_t i = 0; i < frameTimelineValues.size(); i++){
+                vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
+                vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
+                frameArenas[i].destroy();
+            }
+        }
+
+        void applyFramePacing()
+        {
+            bool framesChanged = requestedPacing.framesInFlight != framePacing.framesInFlight;
+            bool imagesChanged = requestedPacing.extraSwapchainImages != framePacing.extraSwapchainImages
+                || requestedPresentMode != presentMode;
+
+            if(!framesChanged && !imagesChanged) return;
+
+            vkDeviceWaitIdle(device);
+
+            framePacing = requestedPacing;
+            presentMode = requestedPresentMode;
+
+            if(framesChanged)
+            {
+                cleanupSyncObjects();
+                destroyFrameCommandPools();
+
+                //nothing is in flight, and queued set frees must not outlive their pool
+                deletionQueue.flushAll();
+
+                vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+                uniformRing.destroy(device);
+
+                createUniformBuffers();
+                createDescriptorPool();
+                createDescriptorSets();
+                createFrameCommandPools();
+                createSyncObjects();
+
+                recorder.destroy();
+                createRecorder();
+
+                allocateCachedCommands();
+
+                currentFrame = 0;
+            }
+
+            if(imagesChanged)
+            { recreateSwapChain(); }
+
+            steadyFrames = 0;
+
+            std::cout << "frame pacing: " << framePacing.framesInFlight << " frames in flight, "
+                << swapChainImages.size() << " swapchain images, " 
+                << presentModeName(swapChainPresentMode) << std::endl;
+        }
+
+        void cyclePresentMode()
+        {
+            auto current = std::find(PRESENT_MODES.begin(), PRESENT_MODES.end(), requestedPresentMode);
+            size_t next = current == PRESENT_MODES.end() ? 0 
+                : (current - PRESENT_MODES.begin() + 1) % PRESENT_MODES.size();
+
+            requestedPresentMode = PRESENT_MODES[next];
+        }
+
+        void cycleFrameRateCap()
+        {
+            auto current = std::find(FRAME_RATE_CAPS.begin(), FRAME_RATE_CAPS.end(), frameRateCap);
+            size_t next = current == FRAME_RATE_CAPS.end() ? 0 
+                : (current - FRAME_RATE_CAPS.begin() + 1) % FRAME_RATE_CAPS.size();
+
+            frameRateCap = FRAME_RATE_CAPS[next];
+            frameLimiter.setTargetFrameTime(frameRateCap > 0.0 ? 1.0 / frameRateCap : 0.0);
+        }
+
+        void reportFrameTiming()
+        {
+            auto now = std::chrono::steady_clock::now();
+            if(now - lastTimingReport < std::chrono::milliseconds(500)) return;
+
+            lastTimingReport = now;
+
+            FrameTimeStats stats = frameLimiter.getStats();
+
+            //written into a fixed buffer so the title update stays off the heap
+            char title[512];
+            PresentLatencyStats latency = presentTimer.getStats();
+            PipelineCompilerStats compiler = pipelineCompiler.getStats();
+
+            int length = snprintf(title, sizeof(title), "VulkanApp | %s | cap %.0f | %s | %.2f ms avg, %.3f ms sd, %.2f-%.2f ms"
+                " | update %.3f ms, render %.3f ms (depth %u)",
+                presentModeName(swapChainPresentMode), frameRateCap, cacheCommands ? "replay" : "record",
+                stats.meanMs, std::sqrt(stats.varianceMs), stats.minMs, stats.maxMs,
+                updateStageMs, renderStageMs, updateDepth);
+
+            if(length > 0 && length < static_cast<int>(sizeof(title)))
+            {
+                length += snprintf(title + length, sizeof(title) - length, " | pipelines %u queued, %u compiling, %.2f ms latency, %u variants for %u states, %u libraries",
+                    compiler.queueDepth, compiler.compiling, compiler.lastLatencyMs, compiler.variantCount, compiler.stateCount,
+                    compiler.libraryCount);
+            }
+
+            //only measurable with present wait
+            if(presentTimer.isEnabled() && length > 0 && length < static_cast<int>(sizeof(title)))
+            {
+                snprintf(title + length, sizeof(title) - length, " | %s to present %.2f ms, %.2f avg, %.2f max",
+                    lateLatching ? "latch" : "snapshot", latency.lastMs, latency.meanMs, latency.maxMs);
+            }
+
+            glfwSetWindowTitle(window, title);
+        }
+
         //-----------------------$Buffers----------------------//
         //-----------------------------------------------------//
         //-----------------------------------------------------//
@@ -775,26 +1606,22 @@ class VulkanApp
             VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
             
             VkBuffer stagingBuffer;
-            VkDeviceMemory stagingBufferMemory;
-            createBuffer(device, physicalDevice, bufferSize,
+            uint32_t stagingBufferAllocation;
+            createBuffer(device, allocator, bufferSize,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer, stagingBufferMemory);
+            stagingBuffer, stagingBufferAllocation);
 
-            void* data;
-            vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-            memcpy(data, vertices.data(), (size_t) bufferSize);
-            vkUnmapMemory(device, stagingBufferMemory);
+            memcpy(allocator.getMapped(stagingBufferAllocation), vertices.data(), (size_t) bufferSize);
 
-            createBuffer(device, physicalDevice, bufferSize,
+            createBuffer(device, allocator, bufferSize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            vertexBuffer, vertexBufferMemory);
+            vertexBuffer, vertexBufferAllocation);
 
             copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
 
-            vkDestroyBuffer(device, stagingBuffer, nullptr);
-            vkFreeMemory(device, stagingBufferMemory, nullptr);
+            destroyBuffer(device, allocator, stagingBuffer, stagingBufferAllocation);
         }
 
         void createIndexBuffer()
@@ -802,68 +1629,155 @@ class VulkanApp
             VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
             
             VkBuffer stagingBuffer;
-            VkDeviceMemory stagingBufferMemory;
-            createBuffer(device, physicalDevice, bufferSize,
+            uint32_t stagingBufferAllocation;
+            createBuffer(device, allocator, bufferSize,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer, stagingBufferMemory);
+            stagingBuffer, stagingBufferAllocation);
 
-            void* data;
-            vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-            memcpy(data, indices.data(), (size_t) bufferSize);
-            vkUnmapMemory(device, stagingBufferMemory);
+            memcpy(allocator.getMapped(stagingBufferAllocation), indices.data(), (size_t) bufferSize);
 
-            createBuffer(device, physicalDevice, bufferSize,
+            createBuffer(device, allocator, bufferSize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            indexBuffer, indexBufferMemory);
+            indexBuffer, indexBufferAllocation);
 
             copyBuffer(stagingBuffer, indexBuffer, bufferSize);
 
-            vkDestroyBuffer(device, stagingBuffer, nullptr);
-            vkFreeMemory(device, stagingBufferMemory, nullptr);
+            destroyBuffer(device, allocator, stagingBuffer, stagingBufferAllocation);
         }
 
         void createUniformBuffers()
         {
-            VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+            uniformRing.create(device, physicalDevice, framePacing.framesInFlight, UNIFORM_RING_FRAME_SIZE);
+        }
 
-            uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-            uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-            uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+        //-----------------------$Update----------------------//
+        //-----------------------------------------------------//
+        //-----------------------------------------------------//
+
+        //only reads state that is fixed once initVulkan returns, so it is safe off the main thread
+        //the scene spins through the view so per-draw data stays static between frames
+        glm::mat4 sampleCamera(std::chrono::high_resolution_clock::time_point now)
+        {
+            float time = std::chrono::duration<float, std::chrono::seconds::period>
+                (now - sceneStartTime).count();
+
+            glm::mat4 view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f),
+                glm::vec3(0.0f, 0.0f, 1.0f));
+
+            return glm::rotate(view, time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        }
+
+        glm::mat4 getProjection()
+        {
+            glm::mat4 proj = glm::perspective(glm::radians(45.0f), 
+                swapChainExtent.width / (float) swapChainExtent.height, 0.1f, 10.0f);
 
-            for(size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+            proj[1][1] *= -1;
+
+            return proj;
+        }
+
+        void simulate(FrameSnapshot &snapshot)
+        {
+            auto currentTime = std::chrono::high_resolution_clock::now();
+
+            snapshot.view = sampleCamera(currentTime);
+            snapshot.sampleTime = std::chrono::steady_clock::now();
+
+            snapshot.draws.clear();
+            for(size_t i = 0; i < objectTransforms.size(); i++)
             {
-                createBuffer(device, physicalDevice, bufferSize,
-                    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                    uniformBuffers[i], uniformBuffersMemory[i]);
+                ObjectPushConstants object{};
+                object.model = objectTransforms[i];
+                object.objectIndex = static_cast<uint32_t>(i);
+                snapshot.draws.push_back(object);
+            }
 
-                vkMapMemory(device, uniformBuffersMemory[i], 0 , bufferSize, 0, 
-                    &uniformBuffersMapped[i]);
+            snapshot.updateMs = std::chrono::duration<double, std::milli>
+                (std::chrono::high_resolution_clock::now() - currentTime).count();
+        }
+
+        void updateLoop()
+        {
+            while(updateRunning.load(std::memory_order_relaxed))
+            {
+                FrameSnapshot *snapshot = snapshots.beginWrite();
+
+                //full means the render thread is depth snapshots behind, wait for it
+                if(snapshot == nullptr)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                simulate(*snapshot);
+                snapshots.endWrite();
             }
         }
 
-        void updateUniformBuffer(uint32_t currentImage)
+        void startUpdateThread()
         {
-            static auto startTime = std::chrono::high_resolution_clock::now();
+            if(updateDepth == 0) return;
 
-            auto currentTime = std::chrono::high_resolution_clock::now();
-            float time = std::chrono::duration<float, std::chrono::seconds::period>
-                (currentTime - startTime).count();
+            snapshots.create(updateDepth);
+            updateRunning.store(true);
+            updateThread = std::thread(&VulkanApp::updateLoop, this);
+        }
+
+        void stopUpdateThread()
+        {
+            if(!updateThread.joinable()) return;
+
+            updateRunning.store(false);
+            updateThread.join();
+        }
+
+        //newest simulation step for the frame being built
+        const FrameSnapshot& acquireSnapshot()
+        {
+            if(updateDepth == 0)
+            {
+                simulate(inlineSnapshot);
+                return inlineSnapshot;
+            }
+
+            const FrameSnapshot *snapshot;
+            while((snapshot = snapshots.acquireLatest()) == nullptr)
+            { std::this_thread::yield(); }
+
+            return *snapshot;
+        }
+
+        void updateUniformBuffer(uint32_t currentImage, const FrameSnapshot &snapshot,
+            ArenaVector<ObjectPushConstants> &draws)
+        {
+            uniformRing.beginFrame(currentImage);
 
             UniformBufferObject ubo{};
-            ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-            
-            ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f),
-                glm::vec3(0.0f, 0.0f, 1.0f));
+            ubo.view = snapshot.view;
+            ubo.proj = getProjection();
 
-            ubo.proj = glm::perspective(glm::radians(45.0f), 
-                swapChainExtent.width / (float) swapChainExtent.height, 0.1f, 10.0f);
+            //kept mapped so latchCamera can overwrite it after recording
+            frameUniformData = uniformRing.allocate(sizeof(ubo), frameUniformOffset);
+            memcpy(frameUniformData, &ubo, sizeof(ubo));
+            cameraSampleTime = snapshot.sampleTime;
 
-            ubo.proj[1][1] *= -1;
+            draws.assign(snapshot.draws.begin(), snapshot.draws.end());
+            updateStageMs = snapshot.updateMs;
+        }
+
+        //recording only baked in the dynamic offset, so the camera can still change up to submit
+        void latchCamera()
+        {
+            UniformBufferObject ubo{};
+            ubo.view = sampleCamera(std::chrono::high_resolution_clock::now());
+            ubo.proj = getProjection();
 
-            memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+            //the ring is host coherent, the submit makes the write visible
+            memcpy(frameUniformData, &ubo, sizeof(ubo));
+            cameraSampleTime = std::chrono::steady_clock::now();
         }
 
         void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
@@ -879,15 +1793,34 @@ class VulkanApp
 
         void drawFrame()
         {
-            vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+            applyFramePacing();
+
+            waitForTimeline(frameTimelineValues[currentFrame]);
+
+            deletionQueue.flush(getCompletedTimelineValue());
+            resetFrameCommandPool(currentFrame);
+
+            reloadShaders();
+
+            //pipelines that finished compiling are swapped in before anything is recorded
+            //the ones they replace may still be in use by frames up to the last submit
+            if(pipelineCompiler.poll(deletionQueue, timelineValue))
+            { markCommandsDirty(COMMANDS_DIRTY_PIPELINE); }
+
+            //that value covers everything this slot's arena handed out last time around
+            FrameArena &frameArena = frameArenas[currentFrame];
+            frameArena.reset();
 
             uint32_t imageIndex;
+            std::unique_lock<std::mutex> swapchainLock(presentTimer.getSwapchainMutex());
             VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, 
                 imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+            swapchainLock.unlock();
 
             if(result == VK_ERROR_OUT_OF_DATE_KHR)
             {
                 recreateSwapChain();
+                steadyFrames = 0;
                 return;
             }
             else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
@@ -895,13 +1828,34 @@ class VulkanApp
                 throw std::runtime_error("failed to acquire swap chain image");
             }
 
-            updateUniformBuffer(currentFrame);
-            
-            vkResetFences(device, 1, &inFlightFences[currentFrame]);
+            frameNumber++;
+            uint64_t heapAllocations = getHeapAllocationCount();
+            DefragStats defragStats = defragmenter.getStats();
+
+            frameTimelineValue = timelineValue + 1;
+
+            ArenaVector<ObjectPushConstants> draws{ArenaAllocator<ObjectPushConstants>(frameArena)};
+            updateUniformBuffer(currentFrame, acquireSnapshot(), draws);
 
-            vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+            applyDefragMoves();
+
+            VkCommandBuffer frameCommands = acquireFrameCommandBuffer();
+
+            std::array<VkCommandBuffer, 2> submitBuffers = {frameCommands, VK_NULL_HANDLE};
+            uint32_t submitBufferCount = 1;
+
+            if(cacheCommands)
+            {
+                recordPrologue(frameCommands);
+                submitBuffers[1] = getCachedCommands(imageIndex, draws);
+                submitBufferCount = 2;
+            }
+            else
+            {
+                recordCommandBuffer(frameCommands, imageIndex, draws, true);
+            }
 
-            recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+            checkFrameHeapAllocations(heapAllocations, defragStats);
 
             VkSubmitInfo submitInfo{};
             submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -911,15 +1865,27 @@ class VulkanApp
             submitInfo.waitSemaphoreCount = 1;
             submitInfo.pWaitSemaphores = waitSemaphores;
             submitInfo.pWaitDstStageMask = waitStages;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
-            VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.commandBufferCount = submitBufferCount;
+            submitInfo.pCommandBuffers = submitBuffers.data();
+            VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame], timeline};
+            submitInfo.signalSemaphoreCount = 2;
             submitInfo.pSignalSemaphores = signalSemaphores;
 
-            if(vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
+            //binary semaphores ignore their value
+            uint64_t waitValues[] = {0};
+            uint64_t signalValues[] = {0, frameTimelineValue};
+            VkTimelineSemaphoreSubmitInfo timelineInfo{};
+            populateTimelineSemaphoreSubmitInfo(timelineInfo, 1, waitValues, 2, signalValues);
+            submitInfo.pNext = &timelineInfo;
+
+            if(lateLatching) latchCamera();
+
+            if(vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
             { throw std::runtime_error("failed to submit draw command"); }
 
+            timelineValue = frameTimelineValue;
+            frameTimelineValues[currentFrame] = frameTimelineValue;
+
             VkPresentInfoKHR presentInfo{};
             presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
             presentInfo.waitSemaphoreCount = 1;
@@ -930,20 +1896,142 @@ class VulkanApp
             presentInfo.pImageIndices = &imageIndex;
             presentInfo.pResults = nullptr;
 
+            uint64_t presentId = ++nextPresentId;
+            VkPresentIdKHR presentIdInfo{};
+            presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+            presentIdInfo.swapchainCount = 1;
+            presentIdInfo.pPresentIds = &presentId;
+
+            if(presentTimer.isEnabled())
+            { presentInfo.pNext = &presentIdInfo; }
+
+            swapchainLock.lock();
             result = vkQueuePresentKHR(presentQueue, &presentInfo);
+            swapchainLock.unlock();
+
+            if(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
+            { presentTimer.track(swapChain, presentId, cameraSampleTime); }
 
             if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR 
                 || frambufferResized)
             {
                 frambufferResized = false;
                 recreateSwapChain();
+                steadyFrames = 0;
             }
             else if(result != VK_SUCCESS)
             {
                 throw std::runtime_error("failed to present swap chain image");
             }
 
-            currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+            currentFrame = (currentFrame + 1) % framePacing.framesInFlight;
+        }
+
+        //-----------------------$Memory----------------------//
+        //----------------------------------------------------//
+        //----------------------------------------------------//
+
+        void createAllocator()
+        {
+            allocator.init(device, physicalDevice, MEMORY_BLOCK_SIZE);
+            defragmenter.init(&allocator, DEFRAG_BYTES_PER_FRAME, DEFRAG_MAX_BLOCK_USAGE);
+            deletionQueue.init(device, &allocator);
+        }
+
+        void applyDefragMoves()
+        {
+            //every submit numbered below this has finished
+            uint64_t completedValue = getCompletedTimelineValue() + 1;
+
+            DefragStats before = defragmenter.getStats();
+
+            defragMoves.clear();
+            defragmenter.update(completedValue, frameTimelineValue, defragMoves);
+
+            //moved buffers and images are baked into cached command buffers
+            if(!defragMoves.empty())
+            { markCommandsDirty(COMMANDS_DIRTY_SCENE); }
+
+            bool descriptorsDirty = false;
+            for(const DefragMove &move : defragMoves)
+            {
+                if(move.oldBuffer != VK_NULL_HANDLE && move.oldBuffer == vertexBuffer)
+                { vertexBuffer = move.newBuffer; }
+                else if(move.oldBuffer != VK_NULL_HANDLE && move.oldBuffer == indexBuffer)
+                { indexBuffer = move.newBuffer; }
+                else if(move.oldImage != VK_NULL_HANDLE && move.oldImage == textureImage)
+                {
+                    textureImage = move.newImage;
+                    deletionQueue.destroyImageView(textureImageView, frameTimelineValue - 1);
+                    createTextureImageView();
+                    descriptorsDirty = true;
+                }
+            }
+
+            //the set may still be read by frames in flight, so write a fresh one instead of patching it
+            if(descriptorsDirty)
+            {
+                deletionQueue.freeDescriptorSet(descriptorPool, descriptorSet, frameTimelineValue - 1);
+                createDescriptorSets();
+            }
+
+            DefragStats after = defragmenter.getStats();
+            if(after.moveCount != before.moveCount || after.releasedBlocks != before.releasedBlocks)
+            { reportMemoryStats(); }
+        }
+
+        void checkFrameHeapAllocations(uint64_t heapAllocationsBefore, const DefragStats &defragStatsBefore)
+        {
+            if(!checkHeapAllocations) return;
+
+            //defrag moves create resources and grow bookkeeping, those frames don't count
+            DefragStats defragStats = defragmenter.getStats();
+            if(defragStats.moveCount != defragStatsBefore.moveCount || defragStats.pendingMoves > 0
+                || defragStatsBefore.pendingMoves > 0)
+            {
+                steadyFrames = 0;
+                return;
+            }
+
+            if(steadyFrames < HEAP_CHECK_WARMUP_FRAMES)
+            {
+                steadyFrames++;
+                return;
+            }
+
+            uint64_t allocations = getHeapAllocationCount() - heapAllocationsBefore;
+            if(allocations > 0)
+            {
+                throw std::runtime_error(std::to_string(allocations) + " heap allocations during steady-state frame "
+                    + std::to_string(frameNumber));
+            }
+        }
+
+        void reportMemoryStats()
+        {
+            AllocatorStats memoryStats = allocator.getStats();
+            DefragStats defragStats = defragmenter.getStats();
+
+            std::cout << "memory: " << memoryStats.blockCount << " blocks, "
+                << memoryStats.usedBytes / 1024 << "/" << memoryStats.blockBytes / 1024 << " KiB used, "
+                << memoryStats.freeRangeCount << " free ranges, largest " 
+                << memoryStats.largestFreeRange / 1024 << " KiB, fragmentation " 
+                << memoryStats.fragmentation << std::endl;
+
+            std::cout << "defrag: " << defragStats.moveCount << " moves, "
+                << defragStats.movedBytes / 1024 << " KiB moved, "
+                << defragStats.releasedBlocks << " blocks released, "
+                << defragStats.pendingMoves << " pending" << std::endl;
+
+            DeletionQueueStats deletionStats = deletionQueue.getStats();
+
+            std::cout << "deletion queue: " << deletionStats.pendingHandles << " handles, "
+                << deletionStats.pendingBytes / 1024 << " KiB pending, "
+                << deletionStats.destroyedHandles << " handles, "
+                << deletionStats.destroyedBytes / 1024 << " KiB destroyed" << std::endl;
+
+            std::cout << "cached commands: " << cachedReplays << " replays, "
+                << cachedRecords << " records" << std::endl;
         }
 
         void createSurface()
@@ -956,17 +2044,12 @@ class VulkanApp
 
         void createDescriptorSetLayout()
         {
-            VkDescriptorSetLayoutBinding uboLayoutBinding{};
-            populateUniformBufferObjectLayoutBinding(uboLayoutBinding);
-
-            VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-            samplerLayoutBinding.binding = 1;
-            samplerLayoutBinding.descriptorCount = 1;
-            samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            samplerLayoutBinding.pImmutableSamplers = nullptr;
-            samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-            std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
+            std::array<VkDescriptorSetLayoutBinding, SHADER_DESCRIPTOR_BINDING_COUNT> bindings;
+            for(uint32_t i = 0; i < SHADER_DESCRIPTOR_BINDING_COUNT; i++)
+            {
+                bindings[i] = SHADER_DESCRIPTOR_BINDINGS[i];
+                bindings[i].descriptorType = getBoundDescriptorType(bindings[i].descriptorType);
+            }
 
             VkDescriptorSetLayoutCreateInfo layoutInfo{};
             populateDescriptorSetLayoutCreateInfo(layoutInfo, bindings);
@@ -977,17 +2060,22 @@ class VulkanApp
 
         void createDescriptorPool()
         {
-            std::array<VkDescriptorPoolSize, 2> poolSizes{};
-            poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-            poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+            std::array<VkDescriptorPoolSize, SHADER_POOL_SIZE_COUNT> poolSizes{};
+            //one live set plus the ones retired while frames in flight still read them
+            uint32_t maxSets = framePacing.framesInFlight + 1;
+
+            for(uint32_t i = 0; i < SHADER_POOL_SIZE_COUNT; i++)
+            {
+                poolSizes[i].type = getBoundDescriptorType(SHADER_POOL_SIZES[i].type);
+                poolSizes[i].descriptorCount = SHADER_POOL_SIZES[i].descriptorCount * maxSets;
+            }
 
             VkDescriptorPoolCreateInfo poolInfo{};
             poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
             poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
             poolInfo.pPoolSizes = poolSizes.data();
-            poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+            poolInfo.maxSets = maxSets;
 
             if(vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
             { throw std::runtime_error("failed to create descriptor pool"); }
@@ -995,37 +2083,31 @@ class VulkanApp
 
         void createDescriptorSets()
         {
-            std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
-            
             VkDescriptorSetAllocateInfo allocInfo{};
             allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
             allocInfo.descriptorPool = descriptorPool;
-            allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-            allocInfo.pSetLayouts = layouts.data();
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &descriptorSetLayout;
 
-            descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-            if(vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+            if(vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS)
             { throw std::runtime_error("failed to allocate descriptor sets"); }
 
-            for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-            {
-                VkDescriptorBufferInfo bufferInfo{};
-                bufferInfo.buffer = uniformBuffers[i];
-                bufferInfo.offset = 0;
-                bufferInfo.range = sizeof(UniformBufferObject);
+            //every frame shares this set, the ring offset is supplied when binding
+            VkDescriptorBufferInfo bufferInfo{};
+            bufferInfo.buffer = uniformRing.getBuffer();
+            bufferInfo.offset = 0;
+            bufferInfo.range = sizeof(UniformBufferObject);
 
-                VkDescriptorImageInfo imageInfo{};
-                imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                imageInfo.imageView = textureImageView;
-                imageInfo.sampler = textureSampler;
+            VkDescriptorImageInfo imageInfo{};
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfo.imageView = textureImageView;
+            imageInfo.sampler = textureSampler;
 
-                std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
-                populateWriteDescriptorSet(descriptorWrites, descriptorSets[i], bufferInfo, imageInfo);
+            std::array<VkWriteDescriptorSet, SHADER_DESCRIPTOR_BINDING_COUNT> descriptorWrites{};
+            populateWriteDescriptorSet(descriptorWrites, descriptorSet, bufferInfo, imageInfo);
 
-                vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), 
-                    descriptorWrites.data(), 0, nullptr);
-            }
-            
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), 
+                descriptorWrites.data(), 0, nullptr);
         }
 
         void createTextureImage()
@@ -1041,22 +2123,20 @@ class VulkanApp
             }
 
             VkBuffer stagingBuffer;
-            VkDeviceMemory stagingBufferMemory;
+            uint32_t stagingBufferAllocation;
 
-            createBuffer(device, physicalDevice, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            createBuffer(device, allocator, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                stagingBuffer, stagingBufferMemory);
+                stagingBuffer, stagingBufferAllocation);
 
-            void* data;
-            vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-            memcpy(data, pixels, static_cast<size_t>(imageSize));
-            vkUnmapMemory(device, stagingBufferMemory);
+            memcpy(allocator.getMapped(stagingBufferAllocation), pixels, static_cast<size_t>(imageSize));
 
             stbi_image_free(pixels);
 
-            createImage(device, physicalDevice, texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+            createImage(device, allocator, texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
                 VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT, 
+                textureImage, textureImageAllocation);
 
             transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED,
                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
@@ -1067,8 +2147,9 @@ class VulkanApp
             transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
-            vkDestroyBuffer(device, stagingBuffer, nullptr);
-            vkFreeMemory(device, stagingBufferMemory, nullptr);
+            allocator.setImageLayout(textureImageAllocation, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+            destroyBuffer(device, allocator, stagingBuffer, stagingBufferAllocation);
         }
 
         void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
@@ -1097,43 +2178,25 @@ class VulkanApp
         {
             VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
-            VkImageMemoryBarrier barrier{};
-            populateImageMemoryBarrier(barrier, oldLayout, newLayout, image);
-
-            VkPipelineStageFlags sourceStage;
-            VkPipelineStageFlags destinationStage;
+            //any pair works, stages and accesses come from what each layout is used for
+            ImageState from = getLayoutState(oldLayout);
+            ImageState to = getLayoutState(newLayout);
 
-            if(oldLayout == VK_IMAGE_LAYOUT_UNDEFINED 
-                && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+            VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+            if(newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
             {
-                barrier.srcAccessMask = 0;
-                barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
+                if(hasStencilComponent(format)) aspectFlags |= VK_IMAGE_ASPECT_STENCIL_BIT;
+            }
 
-                sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-                destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            } 
-            else if(oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL 
-                && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-            {
-                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            VkImageMemoryBarrier2 barrier{};
+            populateImageMemoryBarrier2(barrier, image, aspectFlags, from.stage, from.access, oldLayout,
+                to.stage, to.access, newLayout);
 
-                sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-                destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            }
-            else
-            {
-                throw std::invalid_argument("layout transition not supported");
-            }
+            VkDependencyInfo dependencyInfo{};
+            populateDependencyInfo(dependencyInfo, 1, &barrier);
 
-            vkCmdPipelineBarrier(
-                commandBuffer,
-                sourceStage, destinationStage,
-                0,
-                0, nullptr,
-                0, nullptr,
-                1, &barrier
-            );
+            vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
 
             endSingleTimeCommands(commandBuffer);
         }
@@ -1194,16 +2257,33 @@ class VulkanApp
                 || format == VK_FORMAT_D24_UNORM_S8_UINT;
         }
 
-        void createDepthResources()
+        //rebuilt with the swapchain since transient sizes follow its extent
+        void buildRenderGraph()
         {
-            VkFormat depthFormat = findDepthFormat();
+            renderGraph.reset();
+
+            //handed over by the acquire semaphore, which waits at color attachment output
+            ImageState acquired{VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE,
+                VK_IMAGE_LAYOUT_UNDEFINED};
+
+            graphBackbuffer = renderGraph.importImage("backbuffer", swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT,
+                acquired, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+            renderGraph.markOutput(graphBackbuffer);
 
-            createImage(device, physicalDevice, swapChainExtent.width, swapChainExtent.height, depthFormat, 
-                VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage, depthImageMemory);
+            //cleared on load and discarded on store, so it never outlives the frame
+            graphDepth = renderGraph.createImage("depth", swapChainExtent.width, swapChainExtent.height,
+                depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
 
-            depthImageView = createImageView(device, depthImage, depthFormat, 
-                VK_IMAGE_ASPECT_DEPTH_BIT);
+            uint32_t scenePass = renderGraph.addPass("scene", recordScenePass, this);
+            renderGraph.write(scenePass, graphBackbuffer, GRAPH_COLOR_ATTACHMENT);
+            renderGraph.write(scenePass, graphDepth, GRAPH_DEPTH_ATTACHMENT);
+
+            renderGraph.compile(device, physicalDevice, transientImages);
+
+            depthImage = renderGraph.getImage(graphDepth);
+            depthImageView = renderGraph.getImageView(graphDepth);
+
+            if(dumpRenderGraph) renderGraph.dump(std::cout);
         }
 
         void loadModel()
@@ -1251,6 +2331,9 @@ class VulkanApp
                     indices.push_back(uniqueVertices[vertex]);
                 }
             }
+
+            objectTransforms.push_back(glm::mat4(1.0f));
+            markCommandsDirty(COMMANDS_DIRTY_SCENE);
         }
 
         void initVulkan()
@@ -1261,14 +2344,21 @@ class VulkanApp
             createSurface();
             pickPhysicalDevice();
             createLogicalDevice();
-            createSwapChain();
+            createTimeline();
+            presentTimer.create(device, presentWaitSupported);
+            pipelineCache.create(device, physicalDevice, PIPELINE_CACHE_PATH);
+            pipelineCompiler.create(device, pipelineCache, pipelineThreads, getPipelineDynamicState(),
+                pipelineLibraries && pipelineLibrariesSupported);
+            createAllocator();
+            createSwapChain(VK_NULL_HANDLE);
             createImageViews();
-            createRenderPass();
+            depthFormat = findDepthFormat();
             createDescriptorSetLayout();
             createGraphicsPipeline();
+            if(hotReload) watchShaders();
             createCommandPool();
-            createDepthResources();
-            createFramebuffers();
+            createRecorder();
+            buildRenderGraph();
             createTextureImage();
             createTextureImageView();
             createTextureSampler();
@@ -1278,16 +2368,34 @@ class VulkanApp
             createUniformBuffers();
             createDescriptorPool();
             createDescriptorSets();
-            createCommandBuffers();
+            createFrameCommandPools();
+            allocateCachedCommands();
             createSyncObjects();
         }
 
         void mainLoop()
         {
+            frameLimiter.setTargetFrameTime(frameRateCap > 0.0 ? 1.0 / frameRateCap : 0.0);
+            lastPipelineCacheSave = std::chrono::steady_clock::now();
+
             while(!glfwWindowShouldClose(window))
             {
                 glfwPollEvents();
+                frameLimiter.wait();
+
+                auto renderStart = std::chrono::steady_clock::now();
                 drawFrame();
+                renderStageMs = std::chrono::duration<double, std::milli>
+                    (std::chrono::steady_clock::now() - renderStart).count();
+
+                reportFrameTiming();
+
+                //new pipelines survive a crash without waiting for shutdown
+                if(std::chrono::steady_clock::now() - lastPipelineCacheSave > PIPELINE_CACHE_SAVE_INTERVAL)
+                {
+                    pipelineCache.save();
+                    lastPipelineCacheSave = std::chrono::steady_clock::now();
+                }
             }
 
             vkDeviceWaitIdle(device);
@@ -1295,41 +2403,43 @@ class VulkanApp
 
         void cleanup()
         {
+            presentTimer.destroy();
+            deletionQueue.flushAll();
             cleanupSwapChain();
 
+            defragmenter.destroy();
+
             vkDestroySampler(device, textureSampler, nullptr);
             vkDestroyImageView(device, textureImageView, nullptr);
 
-            vkDestroyImage(device, textureImage, nullptr);
-            vkFreeMemory(device, textureImageMemory, nullptr);
+            destroyImage(device, allocator, textureImage, textureImageAllocation);
 
-            for(size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-            {
-                vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-                vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
-            }
+            uniformRing.destroy(device);
 
             vkDestroyDescriptorPool(device, descriptorPool, nullptr);
 
             vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 
-            vkDestroyBuffer(device, vertexBuffer, nullptr);
-            vkFreeMemory(device, vertexBufferMemory, nullptr);
+            destroyBuffer(device, allocator, vertexBuffer, vertexBufferAllocation);
 
-            vkDestroyBuffer(device, indexBuffer, nullptr);
-            vkFreeMemory(device, indexBufferMemory, nullptr);
+            destroyBuffer(device, allocator, indexBuffer, indexBufferAllocation);
 
-            for(size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++){
-                vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
-                vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-                vkDestroyFence(device, inFlightFences[i], nullptr);
-            }
+            allocator.destroy();
 
+            cleanupSyncObjects();
+            vkDestroySemaphore(device, timeline, nullptr);
+
+            recorder.destroy();
+            destroyFrameCommandPools();
+            vkDestroyCommandPool(device, uploadCommandPool, nullptr);
             vkDestroyCommandPool(device, commandPool, nullptr);
 
-            vkDestroyPipeline(device, graphicsPipeline, nullptr);
+            pipelineCompiler.destroy();
+            shaderWatcher.destroy();
+            vkDestroyShaderModule(device, vertShaderModule, nullptr);
+            vkDestroyShaderModule(device, fragShaderModule, nullptr);
+            pipelineCache.destroy();
             vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-            vkDestroyRenderPass(device, renderPass, nullptr);
 
             vkDestroyDevice(device, nullptr);
 